@@ -0,0 +1,158 @@
+// The random file reader shared by the scheduler (lab2) and the MMU (lab3)
+// Both labs read the same random file format and can use the same binary sidecar, so the parser and the
+// sidecar code live here once and each lab includes this header by relative path
+#ifndef RANDOMFILE_H
+#define RANDOMFILE_H
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Variables to store the random values
+// The random values are read-only once loaded, so any number of simulations can share them
+const int *randomValues;
+int MAX_RANDOM_VALUES_LENGTH;
+
+// A function to parse the integer at the start of a line of text, as atoi does, and advance to the next line
+// Digits are converted eight at a time with SWAR arithmetic on 64-bit words
+int parseRandomLine(const char *text, size_t size, size_t *position)
+{
+    size_t i = *position;
+    // Skip the leading blanks and read the sign
+    while (i < size && (text[i] == ' ' || text[i] == '\t'))
+        i++;
+    bool negative = i < size && text[i] == '-';
+    if (i < size && (text[i] == '-' || text[i] == '+'))
+        i++;
+
+    long long value = 0;
+    while (i + 8 <= size)
+    {
+        // Load eight characters and find the number of leading digits
+        uint64_t chunk;
+        memcpy(&chunk, text + i, 8);
+        uint64_t nonDigits = ((chunk & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x3030303030303030ULL) |
+                             (((chunk & 0x0F0F0F0F0F0F0F0FULL) + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL);
+        uint64_t nonDigitBytes = (((nonDigits & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | nonDigits) & 0x8080808080808080ULL;
+        int numDigits = nonDigitBytes == 0 ? 8 : __builtin_ctzll(nonDigitBytes) / 8;
+        if (numDigits == 0)
+            break;
+
+        // Align the digits to the top of the word, pad with zeros and convert them in three steps
+        if (numDigits < 8)
+            chunk = (chunk << (8 * (8 - numDigits))) | (0x3030303030303030ULL >> (8 * numDigits));
+        chunk = ((chunk & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+        chunk = ((chunk & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+        chunk = ((chunk & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+
+        static const long long powersOfTen[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+        value = value * powersOfTen[numDigits] + (long long)chunk;
+        i += numDigits;
+        if (numDigits < 8)
+            break;
+    }
+    // Convert the remaining digits near the end of the text one at a time
+    while (i < size && text[i] >= '0' && text[i] <= '9')
+        value = value * 10 + (text[i++] - '0');
+
+    // Move to the start of the next line
+    const char *newline = (const char *)memchr(text + i, '\n', size - i);
+    *position = newline != NULL ? newline - text + 1 : size;
+    return (int)(negative ? -value : value);
+}
+
+// A RandomCacheHeader class to store the header of the binary sidecar of a random file
+class RandomCacheHeader
+{
+public:
+    int magic;             // The magic number identifying a random cache file
+    int numValues;         // The number of random values
+    long long sourceSize;  // The size of the random file the cache was built from
+    long long sourceMtime; // The modification time of the random file the cache was built from
+};
+
+const int RANDOM_CACHE_MAGIC = 0x524e4443; // The magic number identifying a random cache file
+
+// A function to map the binary sidecar of the random file, if it is valid for the random file
+// The mapping is shared and read-only, so it is never copied
+bool loadRandomCache(const char *randomFileName, struct stat *randomFileStat)
+{
+    std::string cacheFileName = std::string(randomFileName) + ".bin";
+    int fd = open(cacheFileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat cacheStat;
+    void *cache = MAP_FAILED;
+    if (fstat(fd, &cacheStat) == 0 && cacheStat.st_size >= (off_t)sizeof(RandomCacheHeader))
+        cache = mmap(NULL, cacheStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (cache == MAP_FAILED)
+        return false;
+
+    // Check that the cache was built from the current random file
+    const RandomCacheHeader *header = (const RandomCacheHeader *)cache;
+    if (header->magic != RANDOM_CACHE_MAGIC ||
+        header->sourceSize != randomFileStat->st_size ||
+        header->sourceMtime != randomFileStat->st_mtime ||
+        cacheStat.st_size != (off_t)(sizeof(RandomCacheHeader) + header->numValues * sizeof(int)))
+    {
+        munmap(cache, cacheStat.st_size);
+        return false;
+    }
+    MAX_RANDOM_VALUES_LENGTH = header->numValues;
+    randomValues = (const int *)(header + 1);
+    return true;
+}
+
+// A function to write the binary sidecar of the random file. Failures are ignored as the cache is optional
+void writeRandomCache(const char *randomFileName, struct stat *randomFileStat)
+{
+    std::string cacheFileName = std::string(randomFileName) + ".bin";
+    FILE *cacheFile = fopen(cacheFileName.c_str(), "wb");
+    if (cacheFile == NULL)
+        return;
+    RandomCacheHeader header = {RANDOM_CACHE_MAGIC, MAX_RANDOM_VALUES_LENGTH, (long long)randomFileStat->st_size, (long long)randomFileStat->st_mtime};
+    fwrite(&header, sizeof(RandomCacheHeader), 1, cacheFile);
+    fwrite(randomValues, sizeof(int), MAX_RANDOM_VALUES_LENGTH, cacheFile);
+    fclose(cacheFile);
+}
+
+// A function to read the random values from the random file and populate the randomValues array
+// The random file is mapped into memory and parsed in place. If useRandomCache is set, the binary sidecar
+// <randfile>.bin is mapped instead when it is valid, and written after parsing otherwise
+void readRandomFile(FILE *randomFile, const char *randomFileName, bool useRandomCache = false)
+{
+    struct stat randomFileStat;
+    if (fstat(fileno(randomFile), &randomFileStat) != 0 || randomFileStat.st_size == 0)
+        return;
+    if (useRandomCache && loadRandomCache(randomFileName, &randomFileStat))
+        return;
+
+    // Map the random file. The first line is the number of random values and the rest are the random values
+    size_t size = randomFileStat.st_size;
+    const char *text = (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(randomFile), 0);
+    if (text == MAP_FAILED)
+    {
+        std::cout << "Error: Cannot map random file." << std::endl;
+        exit(1);
+    }
+    size_t position = 0;
+    MAX_RANDOM_VALUES_LENGTH = parseRandomLine(text, size, &position);
+    int *values = (int *)calloc(MAX_RANDOM_VALUES_LENGTH, sizeof(int));
+    for (int i = 0; i < MAX_RANDOM_VALUES_LENGTH && position < size; i++)
+        values[i] = parseRandomLine(text, size, &position);
+    munmap((void *)text, size);
+    randomValues = values;
+
+    if (useRandomCache)
+        writeRandomCache(randomFileName, &randomFileStat);
+}
+
+#endif
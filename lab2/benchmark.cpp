@@ -0,0 +1,240 @@
+// Microbenchmarks for the ready queues of the schedulers and the event queues
+// The scheduler classes are driven directly with synthetic processes at queue depths from 10 to 10^6,
+// reporting the time and the heap allocations per operation
+#define SCHEDULER_BENCHMARK
+#include "scheduler.cpp"
+
+#include <chrono>
+
+// A counter for the heap allocations made through the global operator new
+long long allocationCount = 0;
+
+void *operator new(size_t size)
+{
+    allocationCount++;
+    void *pointer = malloc(size);
+    if (pointer == nullptr)
+        throw bad_alloc();
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t size) noexcept
+{
+    free(pointer);
+}
+
+// The time budget for each measurement and the maximum number of operations measured
+const double TIME_BUDGET_SECONDS = 0.2;
+const long long MAX_OPERATIONS = 1000000;
+
+// A Measurement class to store the cost of the add and get operations of a queue
+class Measurement
+{
+public:
+    long long operations = 0;       // The number of add and the number of get operations measured
+    double addNanoseconds = 0;      // The total time spent in the add operations
+    double getNanoseconds = 0;      // The total time spent in the get operations
+    long long addAllocations = 0;   // The total number of allocations made by the add operations
+    long long getAllocations = 0;   // The total number of allocations made by the get operations
+};
+
+// A function to return the current time in nanoseconds
+double now()
+{
+    return chrono::duration<double, nano>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The cost of reading the clock, subtracted from every timed batch
+double timerOverhead = 0;
+
+// A function to measure the cost of reading the clock
+void calibrateTimer()
+{
+    const int samples = 100000;
+    double total = 0;
+    for (int i = 0; i < samples; i++)
+    {
+        double begin = now();
+        total += now() - begin;
+    }
+    timerOverhead = total / samples;
+}
+
+// A function to return the largest batch size for a queue depth
+// Batches start at one operation and double every round, so that slow queues stay within the time budget
+int maxBatchSize(int depth)
+{
+    return max(1, min(depth / 10, 1000));
+}
+
+// A function to create a synthetic process with random CPU time, priority and deadline
+Process *createSyntheticProcess(int processNumber, int maxprios)
+{
+    Process *process = new Process();
+    process->processNumber = processNumber;
+    process->arrivalTime = 0;
+    process->cpuTime = 1 + rand() % 10000;
+    process->remainingCpuTime = process->cpuTime;
+    process->cpuBurst = 10;
+    process->currentCpuBurst = 0;
+    process->ioBurst = 10;
+    process->staticPriority = 1 + rand() % maxprios;
+    process->dynamicPriority = process->staticPriority - 1;
+    process->stateTimeStamp = 0;
+    processDeadlines[processNumber].relativeDeadline = 1 + rand() % 10000;
+    processDeadlines[processNumber].absoluteDeadline = processDeadlines[processNumber].relativeDeadline;
+    return process;
+}
+
+// A function to measure the ready queue of a scheduler at a given depth
+// Each round takes up to a tenth of the queue out with getNextProcess and puts it back with addProcess,
+// so the depth stays between 90% and 100% of the given depth
+Measurement measureScheduler(Scheduler *scheduler, int depth)
+{
+    for (int i = 0; i < depth; i++)
+        scheduler->addProcess(createSyntheticProcess(i, scheduler->maxprios));
+
+    Measurement measurement;
+    int batch = 1;
+    vector<Process *> taken(maxBatchSize(depth));
+    double start = now();
+    while (now() - start < TIME_BUDGET_SECONDS * 1e9 && measurement.operations < MAX_OPERATIONS)
+    {
+        // Take a batch of processes out of the ready queue
+        long long allocations = allocationCount;
+        double begin = now();
+        for (int i = 0; i < batch; i++)
+            taken[i] = scheduler->getNextProcess();
+        measurement.getNanoseconds += max(0.0, now() - begin - timerOverhead);
+        measurement.getAllocations += allocationCount - allocations;
+
+        // Update the processes as if they had run, and put them back into the ready queue
+        for (int i = 0; i < batch; i++)
+        {
+            taken[i]->remainingCpuTime = 1 + rand() % 10000;
+            taken[i]->dynamicPriority--;
+            processDeadlines[taken[i]->processNumber].absoluteDeadline += 1 + rand() % 10000;
+        }
+        allocations = allocationCount;
+        begin = now();
+        for (int i = 0; i < batch; i++)
+            scheduler->addProcess(taken[i]);
+        measurement.addNanoseconds += max(0.0, now() - begin - timerOverhead);
+        measurement.addAllocations += allocationCount - allocations;
+        measurement.operations += batch;
+        batch = min(2 * batch, maxBatchSize(depth));
+    }
+    return measurement;
+}
+
+// A function to measure the event queue at a given depth, with the sorted vector or the calendar queue
+// Each round takes up to a tenth of the events out with getEvent and adds them back later in time with addEvent
+Measurement measureEventQueue(int depth, bool useCalendarQueue)
+{
+    eventQueue.clear();
+    eventQueueHead = 0;
+    delete calendarQueue;
+    calendarQueue = useCalendarQueue ? new CalendarQueue() : nullptr;
+    for (int i = 0; i < depth; i++)
+    {
+        Event *event = new Event();
+        event->timeStamp = rand() % depth;
+        event->process = createSyntheticProcess(i, 4);
+        event->oldState = READY;
+        event->newState = RUNNING;
+        event->transition = TO_RUNNING;
+        // Fill the sorted vector directly, as filling it through addEvent is quadratic
+        if (useCalendarQueue)
+            addEvent(event);
+        else
+            eventQueue.push_back(event);
+    }
+    stable_sort(eventQueue.begin(), eventQueue.end(), [](Event *a, Event *b)
+                { return a->timeStamp < b->timeStamp; });
+
+    Measurement measurement;
+    int batch = 1;
+    vector<Event *> taken(maxBatchSize(depth));
+    double start = now();
+    while (now() - start < TIME_BUDGET_SECONDS * 1e9 && measurement.operations < MAX_OPERATIONS)
+    {
+        // Take a batch of events out of the event queue
+        long long allocations = allocationCount;
+        double begin = now();
+        for (int i = 0; i < batch; i++)
+            taken[i] = getEvent();
+        measurement.getNanoseconds += max(0.0, now() - begin - timerOverhead);
+        measurement.getAllocations += allocationCount - allocations;
+
+        // Schedule the events again later in time
+        for (int i = 0; i < batch; i++)
+            taken[i]->timeStamp += 1 + rand() % depth;
+        allocations = allocationCount;
+        begin = now();
+        for (int i = 0; i < batch; i++)
+            addEvent(taken[i]);
+        measurement.addNanoseconds += max(0.0, now() - begin - timerOverhead);
+        measurement.addAllocations += allocationCount - allocations;
+        measurement.operations += batch;
+        batch = min(2 * batch, maxBatchSize(depth));
+    }
+    return measurement;
+}
+
+// A function to print a measurement
+void displayMeasurement(string name, int depth, Measurement measurement)
+{
+    cout << setw(10) << left << name << right
+         << setw(9) << depth
+         << fixed << setprecision(1)
+         << setw(12) << measurement.addNanoseconds / measurement.operations
+         << setw(12) << measurement.getNanoseconds / measurement.operations
+         << setprecision(3)
+         << setw(12) << measurement.addAllocations / (double)measurement.operations
+         << setw(12) << measurement.getAllocations / (double)measurement.operations << endl;
+}
+
+// Main function
+int main(int argc, char *argv[])
+{
+    // The largest queue depth can be lowered on the command line for quick runs
+    int maxDepth = argc > 1 ? atoi(argv[1]) : 1000000;
+    srand(42);
+    calibrateTimer();
+
+    // The lottery scheduler draws from the random values, which are generated instead of read from a file
+    vector<int> syntheticRandomValues(40000);
+    for (int i = 0; i < syntheticRandomValues.size(); i++)
+        syntheticRandomValues[i] = rand();
+    randomValues = syntheticRandomValues.data();
+    MAX_RANDOM_VALUES_LENGTH = syntheticRandomValues.size();
+
+    cout << setw(10) << left << "queue" << right
+         << setw(9) << "depth"
+         << setw(12) << "add ns/op"
+         << setw(12) << "get ns/op"
+         << setw(12) << "add allocs"
+         << setw(12) << "get allocs" << endl;
+
+    const char *schedulerSpecs[] = {"F", "L", "S", "R2", "P2", "E2", "C", "T2", "O2", "D"};
+    for (const char *schedulerSpec : schedulerSpecs)
+    {
+        for (int depth = 10; depth <= maxDepth; depth *= 10)
+        {
+            string spec = schedulerSpec;
+            Scheduler *scheduler = initScheduler(&spec[0]);
+            displayMeasurement(scheduler->name, depth, measureScheduler(scheduler, depth));
+        }
+    }
+    for (int depth = 10; depth <= maxDepth; depth *= 10)
+        displayMeasurement("EVENTS", depth, measureEventQueue(depth, false));
+    for (int depth = 10; depth <= maxDepth; depth *= 10)
+        displayMeasurement("CALENDAR", depth, measureEventQueue(depth, true));
+
+    return 0;
+}
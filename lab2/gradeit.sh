@@ -21,11 +21,11 @@ usage() {
 
 LOG=${3:-${DIR2}/LOG.txt}
 DARGS="-B"
-INS="`seq 0 7`"
+INS=${INS:-"`seq 0 7`"}
 OUTPRE="out"
 CHKSUM="md5sum" 
 
-SCHEDS="   F    L    S   R2   R5   P2   P5:3 E2:5  E4"  
+SCHEDS=${SCHEDS:-"   F    L    S   R2   R5   P2   P5:3 E2:5  E4"}
 
 #SCHEDS="   F"     # example if you only want to run the F scheduler during development
 
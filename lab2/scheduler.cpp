@@ -9,29 +9,89 @@
 #include <queue>
 #include <deque>
 #include <algorithm>
+#include <map>
+#include <vector>
+#include <new>
+#include <cstdint>
+#include <cmath>
+#include <climits>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "../common/randomfile.h"
 
 using namespace std;
 
 // A Process class to store the process information
-class Process
+// Each process occupies exactly one cache line, so the event loop touches one line per process. The fields
+// used on every event are grouped at the front for readability only, as they share that line with the
+// reporting fields. The locality across processes comes from allocating them contiguously from slabs
+class alignas(64) Process
 {
 public:
-    int processNumber;            // The process number
-    int arrivalTime;              // The arrival time of the process
-    int cpuTime;                  // The CPU time of the process
+    // Fields used on every event
     int remainingCpuTime;         // The remaining CPU time of the process
-    int cpuBurst;                 // The defined CPU burst of the process
     int currentCpuBurst;          // The current CPU burst of the process
-    int ioBurst;                  // The defined I/O burst of the process
-    int staticPriority;           // The static priority of the process
     int dynamicPriority;          // The dynamic priority of the process
     int stateTimeStamp;           // The time stamp when the process changed state
-    int finishTime;               // The finish time of the process
-    int turnaroundTime;           // The turnaround time of the process
-    int ioTime = 0;               // The time spent in I/O
-    int cpuWaitTime = 0;          // The time spent waiting for the CPU in the ready state
+    int processNumber;            // The process number
+    int staticPriority;           // The static priority of the process
+    int cpuBurst;                 // The defined CPU burst of the process
+    int ioBurst;                  // The defined I/O burst of the process
     int lastCpuExecutionTime = 0; // The time of the last CPU execution
+    int cpu = 0;                  // The CPU whose ready queue the process was last assigned to
+
+    // Fields used for reporting
+    int arrivalTime;     // The arrival time of the process
+    int cpuTime;         // The CPU time of the process
+    int finishTime;      // The finish time of the process
+    int turnaroundTime;  // The turnaround time of the process
+    int ioTime = 0;      // The time spent in I/O
+    int cpuWaitTime = 0; // The time spent waiting for the CPU in the ready state
+
+    // Processes are allocated from slabs so that they are contiguous in memory
+    static void *operator new(size_t size);
+    static void operator delete(void *pointer);
 };
+static_assert(sizeof(Process) == 64, "A process must fit in one cache line");
+
+// Variables to store the slab allocator state for processes
+const int PROCESS_SLAB_SIZE = 4096; // The number of processes in a slab
+Process *nextProcessSlot = nullptr; // The next unused process in the current slab
+Process *processSlabEnd = nullptr;  // The end of the current slab
+vector<void *> freeProcessSlots;    // The released processes available for reuse
+
+// A function to allocate a process from the current slab, reusing released processes first
+void *Process::operator new(size_t size)
+{
+    if (!freeProcessSlots.empty())
+    {
+        void *slot = freeProcessSlots.back();
+        freeProcessSlots.pop_back();
+        return slot;
+    }
+    if (nextProcessSlot == processSlabEnd)
+    {
+        // Allocate a new slab when the current slab is exhausted
+        nextProcessSlot = (Process *)aligned_alloc(alignof(Process), PROCESS_SLAB_SIZE * sizeof(Process));
+        if (nextProcessSlot == nullptr)
+            throw bad_alloc();
+        processSlabEnd = nextProcessSlot + PROCESS_SLAB_SIZE;
+    }
+    return nextProcessSlot++;
+}
+
+// A function to release a process so that its slot is reused by the next allocation
+void Process::operator delete(void *pointer)
+{
+    freeProcessSlots.push_back(pointer);
+}
 
 // A state enum to store the state of the process
 enum State
@@ -40,6 +100,7 @@ enum State
     READY,   // The process is ready
     RUNNING, // The process is running
     BLOCKED, // The process is blocked
+    WAITING, // The periodic process waits for the release of its next job
 };
 
 // A transition enum to store the transition of the process
@@ -62,558 +123,2717 @@ public:
     Transition transition; // The transition of the process from the old state to the new state
 };
 
-// A Scheduler class to store the scheduler information
-class Scheduler
+// A function to map the state enum to a string representation
+string stateToString(State state)
 {
-public:
-    string name;                      // The name of the scheduler
-    int quantum = 10000;              // The quantum of the scheduler. Default value is 10K
-    int maxprios = 4;                 // The maximum number of priorities. Default value is 4
-    int ioTime = 0;                   // The time spent in I/O
-    vector<vector<int>> ioTimeStamps; // The time stamps for I/O
-    int cpuTime = 0;                  // The time spent by CPU
-    virtual bool checkEventPreemption(Process *activatedProcess, Process *currentRunningProcess, int currentTime, bool showPreemptionDecision)
+    switch (state)
     {
-        // A function to test if the current process should be preempt the running process
-        // Default implementation is to return false
-        return false;
+    case CREATED:
+        return "CREATED";
+    case READY:
+        return "READY";
+    case RUNNING:
+        return "RUNNING";
+    case BLOCKED:
+        return "BLOCKED";
+    case WAITING:
+        return "WAITING";
     }
-    virtual void addProcess(Process *process) = 0; // A function to add a process to the ready queue
-    virtual Process *getNextProcess() = 0;         // A function to get the next process from the ready queue
-    virtual void showReadyQueue() = 0;             // A function to show the ready queue
+    return "";
+}
+
+// A trace record type enum to store the kind of output a trace record reproduces
+enum TraceRecordType
+{
+    TRACE_TRANSITION,        // A state transition, shown with -v
+    TRACE_ADD_EVENT,         // The header of an event insertion, shown with -e
+    TRACE_EVENT_QUEUE_EMPTY, // An empty event queue
+    TRACE_EVENT_QUEUE_ENTRY, // An entry of the event queue
+    TRACE_EVENT_QUEUE_ARROW, // The separator between the event queue before and after insertion
+    TRACE_READY_QUEUE,       // The header of the ready queue, shown with -t
+    TRACE_READY_QUEUE_ENTRY, // An entry of the ready queue
+    TRACE_PREEMPTION,        // A preemption decision, shown with -p
+    TRACE_END_LINE,          // The end of a line
 };
 
-// A queue to store the events, implemented as a vector for inserting events in order of the timestamp
-vector<Event *> eventQueue;
+// A trace message enum to store the message appended to a state transition
+enum TraceMessage
+{
+    NO_MESSAGE,        // No message
+    CPU_BURST_MESSAGE, // The CPU burst, remaining time and priority
+    IO_BURST_MESSAGE,  // The I/O burst and remaining time
+    DONE_MESSAGE,      // The process is done, shown instead of the transition
+};
 
-// Initialize the scheduler object.
-Scheduler *scheduler = nullptr;
+// A trace ready queue entry enum to store how an entry of the ready queue is shown
+enum TraceReadyQueueEntry
+{
+    PLAIN_ENTRY,   // The time stamp and the process number
+    ACTIVE_ENTRY,  // The time stamp, the process number and the priority of an active process
+    EXPIRED_ENTRY, // The time stamp, the process number and the priority of an expired process
+};
 
-// A First Come First Serve (FCFS) Scheduler class
-class FCFS : public Scheduler
+// A trace preemption enum to store which scheduler made a preemption decision
+enum TracePreemption
+{
+    PRIORITY_PREEMPTION,        // The dynamic priority comparison of PREPRIO
+    VIRTUAL_RUNTIME_PREEMPTION, // The virtual runtime comparison of CFS
+    DEADLINE_PREEMPTION,        // The absolute deadline comparison of EDF
+};
+
+// A TraceRecord class to store a fixed-size binary trace record
+// Every piece of verbose output is a trace record, which is either decoded to text immediately
+// or appended to the binary trace file and decoded later with -d
+class TraceRecord
 {
-    deque<Process *> readyQueue; // The ready queue to store the processes
 public:
-    // Constructor to initialize the name of the scheduler
-    FCFS()
+    uint8_t type;      // The trace record type
+    uint8_t kind;      // The message of a transition or the kind of a ready queue entry
+    uint8_t oldState;  // The old state of a transition or event
+    uint8_t newState;  // The new state of a transition or event
+    int32_t values[6]; // The values shown by the record, depending on the type
+};
+
+// Variables to store the header written at the start of a binary trace file
+const int TRACE_MAGIC = 0x53435254; // The magic number identifying a binary trace file
+const int TRACE_VERSION = 1;        // The version of the trace record layout, changed whenever TraceRecord changes
+
+// A TraceBuffer class to buffer binary trace records in memory and flush them to the trace file
+// The trace file starts with the magic number and the version, followed by the records
+class TraceBuffer
+{
+public:
+    static const int CAPACITY = 65536; // The number of records buffered before flushing
+    TraceRecord *records;              // The buffered records
+    int count = 0;                     // The number of buffered records
+    FILE *file;                        // The binary trace file
+
+    TraceBuffer(FILE *file)
     {
-        name = "FCFS";
+        this->file = file;
+        records = new TraceRecord[CAPACITY];
+        const int header[2] = {TRACE_MAGIC, TRACE_VERSION};
+        fwrite(header, sizeof(int), 2, file);
     }
-    // Add a process to the ready queue
-    void addProcess(Process *process)
+
+    // Append a record, flushing the buffer to the trace file when it is full
+    void append(const TraceRecord &record)
     {
-        readyQueue.push_back(process);
+        records[count++] = record;
+        if (count == CAPACITY)
+            flush();
     }
 
-    // Get the next process from the ready queue. The first process added is returned first
-    Process *getNextProcess()
+    // Write the buffered records to the trace file
+    void flush()
     {
-        if (readyQueue.empty())
-            return NULL;
-        Process *process = readyQueue.front();
-        readyQueue.pop_front();
-        return process;
+        fwrite(records, sizeof(TraceRecord), count, file);
+        count = 0;
     }
+};
 
-    // Show the ready queue
-    void showReadyQueue()
+// The binary trace buffer. If it is not set, trace records are decoded to text immediately
+TraceBuffer *traceBuffer = nullptr;
+
+// A function to decode a trace record to its text representation
+void decodeTraceRecord(const TraceRecord &record)
+{
+    const int32_t *values = record.values;
+    switch (record.type)
     {
-        if (readyQueue.empty())
-            cout << "SCHED (0): ";
+    case TRACE_TRANSITION:
+        cout << "t=" << values[0] << " pid=" << values[1] << " tps=" << values[2] << ": ";
+        if (record.kind == DONE_MESSAGE)
+            cout << "DONE ";
         else
+            cout << stateToString((State)record.oldState) << " -> " << stateToString((State)record.newState) << " ";
+        if (record.kind == CPU_BURST_MESSAGE)
+            cout << "[cb=" << values[3] << " rem=" << values[4] << " prio=" << values[5] << "]";
+        else if (record.kind == IO_BURST_MESSAGE)
+            cout << "[ib=" << values[3] << " rem=" << values[4] << "]";
+        cout << endl;
+        break;
+    case TRACE_ADD_EVENT:
+        cout << "AddEvent(t=" << values[0]
+             << " pid=" << values[1]
+             << " prio=" << values[2]
+             << " trans=" << stateToString((State)record.oldState) << "->" << stateToString((State)record.newState) << "): ";
+        break;
+    case TRACE_EVENT_QUEUE_EMPTY:
+        cout << "()";
+        break;
+    case TRACE_EVENT_QUEUE_ENTRY:
+        cout << "(t=" << values[0] << " "
+             << "pid=" << values[1] << " "
+             << "prio=" << values[2] << " "
+             << stateToString((State)record.oldState) << "->"
+             << stateToString((State)record.newState) << ") | ";
+        break;
+    case TRACE_EVENT_QUEUE_ARROW:
+        cout << " => ";
+        break;
+    case TRACE_READY_QUEUE:
+        cout << "SCHED (" << values[0] << "): ";
+        break;
+    case TRACE_READY_QUEUE_ENTRY:
+        if (record.kind == PLAIN_ENTRY)
+            cout << "(t=" << values[0] << " pid=" << values[1] << ") ";
+        else if (record.kind == ACTIVE_ENTRY)
+            cout << "(t=" << values[0] << " pid=" << values[1] << " prio=" << values[2] << " active) ";
+        else
+            cout << "(t=" << values[0] << " pid=" << values[1] << " prio=" << values[2] << ") expired) ";
+        break;
+    case TRACE_PREEMPTION:
+        if (record.kind == VIRTUAL_RUNTIME_PREEMPTION)
         {
-            cout << "SCHED (" << readyQueue.size() << "): ";
-            for (int i = 0; i < readyQueue.size(); i++)
-                cout << "(t=" << readyQueue[i]->stateTimeStamp << " pid=" << readyQueue[i]->processNumber << ") ";
-            cout << endl;
+            cout << "\t--> CfsPreempt currentRunningProcess.vruntime - activatedProcess.vruntime > wakeupGranularity: " << values[0]
+                 << " noEventPending: " << values[1]
+                 << " Decision: " << (values[2] ? "YES" : "NO") << endl;
+            break;
+        }
+        if (record.kind == DEADLINE_PREEMPTION)
+        {
+            cout << "\t--> EdfPreempt activatedProcess.deadline < currentRunningProcess.deadline: " << values[0]
+                 << " noEventPending: " << values[1]
+                 << " Decision: " << (values[2] ? "YES" : "NO") << endl;
+            break;
         }
+        cout << "\t--> PrioPreempt activatedProcess.dynamicPriority > currentRunningProcess.dynamicPriority: " << values[0]
+             << " noEventPending: " << values[1]
+             << " Decision: " << (values[2] ? "YES" : "NO") << endl;
+        break;
+    case TRACE_END_LINE:
+        cout << endl;
+        break;
     }
-};
+}
 
-// A Last Come First Serve (LCFS) Scheduler class
-class LCFS : public Scheduler
+// A function to emit a trace record, either to the binary trace buffer or as text
+void emitTraceRecord(uint8_t type, uint8_t kind = 0, uint8_t oldState = 0, uint8_t newState = 0,
+                     int32_t value0 = 0, int32_t value1 = 0, int32_t value2 = 0,
+                     int32_t value3 = 0, int32_t value4 = 0, int32_t value5 = 0)
 {
-    deque<Process *> readyQueue; // The ready queue to store the processes
-public:
-    // Constructor to initialize the name of the scheduler
-    LCFS()
+    TraceRecord record = {type, kind, oldState, newState, {value0, value1, value2, value3, value4, value5}};
+    if (traceBuffer != nullptr)
+        traceBuffer->append(record);
+    else
+        decodeTraceRecord(record);
+}
+
+// A function to decode a binary trace file to text
+void decodeTraceFile(FILE *traceFile)
+{
+    int header[2];
+    if (fread(header, sizeof(int), 2, traceFile) != 2 || header[0] != TRACE_MAGIC)
     {
-        name = "LCFS";
+        cout << "Error: Not a binary trace file." << endl;
+        exit(1);
     }
-    // Add a process to the ready queue
-    void addProcess(Process *process)
+    if (header[1] != TRACE_VERSION)
     {
-        readyQueue.push_back(process);
+        cout << "Error: Unsupported binary trace version " << header[1] << "." << endl;
+        exit(1);
     }
 
-    // Get the next process from the ready queue. The last process added is returned first
-    Process *getNextProcess()
-    {
-        if (readyQueue.empty())
-            return NULL;
-        Process *process = readyQueue.back();
-        readyQueue.pop_back();
-        return process;
-    }
+    static TraceRecord records[TraceBuffer::CAPACITY];
+    size_t count;
+    while ((count = fread(records, sizeof(TraceRecord), TraceBuffer::CAPACITY, traceFile)) > 0)
+        for (size_t i = 0; i < count; i++)
+            decodeTraceRecord(records[i]);
+}
 
-    // Show the ready queue
-    void showReadyQueue()
-    {
-        if (readyQueue.empty())
-            cout << "SCHED (0): ";
-        else
-        {
-            cout << "SCHED (" << readyQueue.size() << "): ";
-            for (int i = 0; i < readyQueue.size(); i++)
-                cout << "(t=" << readyQueue[i]->stateTimeStamp << " pid=" << readyQueue[i]->processNumber << ") ";
-            cout << endl;
-        }
-    }
+// A function to show the header of a ready queue with the number of processes in it
+void showReadyQueueHeader(int numProcesses)
+{
+    emitTraceRecord(TRACE_READY_QUEUE, 0, 0, 0, numProcesses);
+}
+
+// A function to show an entry of a ready queue
+void showReadyQueueEntry(Process *process, TraceReadyQueueEntry entry = PLAIN_ENTRY)
+{
+    emitTraceRecord(TRACE_READY_QUEUE_ENTRY, entry, 0, 0, process->stateTimeStamp, process->processNumber, process->dynamicPriority);
+}
+
+// A function to end the current line of the verbose output
+void showEndLine()
+{
+    emitTraceRecord(TRACE_END_LINE);
+}
+
+// A SchedulerCounters class to store the performance counters of the simulator, exported as JSON with -j
+// The counters are only updated when they are allocated, so they cost a single pointer test when disabled
+class SchedulerCounters
+{
+public:
+    long long eventsProcessed[4] = {}; // The number of events processed by transition
+    long long eventsAdded = 0;         // The number of events added to the event queue
+    long long eventInsertProbes = 0;   // The number of event queue entries compared while adding events
+    long long eventsAppended = 0;      // The number of events added at the end of the event queue
+    long long maxEventQueueLength = 0; // The largest length of the event queue
+    long long preemptionChecks = 0;    // The number of preemption checks when a process becomes ready
+    long long preemptions = 0;         // The number of preemption checks that preempted the running process
+    long long contextSwitches = 0;     // The number of processes dispatched to a CPU
+    long long readyQueueHighWater = 0; // The largest length of the ready queue of a CPU
+    double phaseMicroseconds[4] = {};  // The wall-clock time of each phase of the simulator
 };
 
-// A Shortest Remaining Time First (SRTF) Scheduler class
-class SRTF : public Scheduler
+// A phase enum to store the phases of the simulator timed by the counters
+enum SimulatorPhase
+{
+    READ_RANDOM_FILE_PHASE,     // Reading the random file
+    READ_INPUT_FILE_PHASE,      // Reading the input file
+    SIMULATE_PHASE,             // Running the simulation
+    DISPLAY_PROCESS_INFO_PHASE, // Printing the summary
+};
+
+// The performance counters. If they are not set, no counters are collected
+SchedulerCounters *counters = nullptr;
+
+// A function to return the current wall-clock time in microseconds
+double wallClockMicroseconds()
+{
+    return chrono::duration<double, micro>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// A function to add the time since the start of a phase to the counters and start the next phase
+void endPhase(SimulatorPhase phase, double *phaseStart)
+{
+    if (counters == nullptr)
+        return;
+    double now = wallClockMicroseconds();
+    counters->phaseMicroseconds[phase] += now - *phaseStart;
+    *phaseStart = now;
+}
+
+// A vector to store the processes
+vector<Process *> processes;
+
+// A ProcessTable class to store a value for each process by process number, outside the Process class
+// In streaming and live mode the processes are summarized and released in order of process number, so the values
+// before the next process to summarize are dropped and the table only spans the processes not yet summarized.
+// The dropped values are erased once they are half of the table, so a lookup stays a plain vector access
+template <typename T>
+class ProcessTable
 {
-    deque<Process *> readyQueue; // The ready queue to store the processes
 public:
-    // Constructor to initialize the name of the scheduler
-    SRTF()
-    {
-        name = "SRTF";
-    }
-    // Add a process to the ready queue
-    void addProcess(Process *process)
+    vector<T> values; // The values of the processes from the first kept one
+    int first = 0;    // The process number of the first kept value
+    T defaultValue;   // The value of a process that has not been given one
+
+    ProcessTable(T defaultValue = T()) : defaultValue(defaultValue) {}
+
+    // Return one past the largest process number with a value
+    int end()
     {
-        readyQueue.push_back(process);
+        return first + values.size();
     }
 
-    // Get the next process from the ready queue. The process with the shortest remaining CPU time is returned first
-    Process *getNextProcess()
+    // Return the value of a process, adding default values up to it if needed
+    T &operator[](int processNumber)
     {
-        if (readyQueue.empty())
-            return NULL;
-        Process *shortestProcess = readyQueue.front();
-        for (int i = 1; i < readyQueue.size(); i++)
-        {
-            if (readyQueue[i]->remainingCpuTime < shortestProcess->remainingCpuTime)
-                shortestProcess = readyQueue[i];
-        }
-        readyQueue.erase(remove(readyQueue.begin(), readyQueue.end(), shortestProcess), readyQueue.end());
-        return shortestProcess;
+        if (processNumber >= end())
+            values.resize(processNumber + 1 - first, defaultValue);
+        return values[processNumber - first];
     }
 
-    // Show the ready queue
-    void showReadyQueue()
+    // Drop the values of the processes before a process number
+    void releaseBefore(int processNumber)
     {
-        if (readyQueue.empty())
-            cout << "SCHED (0): ";
-        else
+        int released = min(processNumber, end()) - first;
+        if (released > 0 && 2 * released >= values.size())
         {
-            cout << "SCHED (" << readyQueue.size() << "): ";
-            for (int i = 0; i < readyQueue.size(); i++)
-                cout << "(t=" << readyQueue[i]->stateTimeStamp << " pid=" << readyQueue[i]->processNumber << ") ";
-            cout << endl;
+            values.erase(values.begin(), values.begin() + released);
+            first += released;
         }
     }
 };
 
-// A Round Robin (RR) Scheduler class
-class RoundRobin : public Scheduler
+// A table to store the tickets of each process from the optional fifth input column, 0 if not given
+// The tickets are kept outside the Process class so that a process still fits in one cache line
+ProcessTable<int> processTickets;
+const int DEFAULT_TICKETS_PER_PRIORITY = 100; // The tickets per static priority level if the column is not given
+
+// A function to return the tickets of a process for the STRIDE and LOTTERY schedulers
+int getTickets(Process *process)
+{
+    if (processTickets[process->processNumber] > 0)
+        return processTickets[process->processNumber];
+    return process->staticPriority * DEFAULT_TICKETS_PER_PRIORITY;
+}
+
+// A ProcessDeadline class to store the real-time parameters of a process from the optional sixth and seventh
+// input columns, and the deadline statistics of its jobs. Without a period the whole process is one job, with a
+// period the CPU bursts are its successive jobs. The k-th job is released at arrivalTime + k * period, or when the
+// process returns from I/O if that is later, and is due relativeDeadline after its release
+class ProcessDeadline
 {
-    deque<Process *> readyQueue; // The ready queue to store the processes
 public:
-    // Constructor to initialize the name of the scheduler and the quantum
-    RoundRobin(int quantum)
-    {
-        name = "RR " + to_string(quantum);
-        this->quantum = quantum;
-    }
-    // Add a process to the ready queue
-    void addProcess(Process *process)
-    {
-        readyQueue.push_back(process);
-    }
+    int relativeDeadline = 0;       // The deadline of a job relative to its release, 0 if the process has no deadline
+    int period = 0;                 // The time between the releases of the jobs, 0 if the process is a single job
+    int absoluteDeadline = INT_MAX; // The deadline of the current job
+    int jobs = 0;                   // The number of completed jobs
+    int misses = 0;                 // The number of jobs completed after their deadline
+    int maxLateness = INT_MIN;      // The largest lateness of a completed job
+    long long totalLateness = 0;    // The total lateness of the completed jobs, negative when they finish early
+};
 
-    // Get the next process from the ready queue. The process is returned in a round-robin fashion based on the quantum.
-    Process *getNextProcess()
+// A table to store the deadline of each process, kept outside the Process class like the tickets
+ProcessTable<ProcessDeadline> processDeadlines;
+bool hasDeadlines = false; // Whether any process has a deadline, which adds the deadline statistics to the summary
+
+// A function to return the absolute deadline of the current job of a process, INT_MAX if it has no deadline
+int getDeadline(Process *process)
+{
+    if (process->processNumber < processDeadlines.end())
+        return processDeadlines[process->processNumber].absoluteDeadline;
+    return INT_MAX;
+}
+
+// A function to record the end of a CPU burst of a process
+// A job completes at the end of every burst of a periodic process, and when the process finishes otherwise
+void completeJob(Process *process, int currentTime)
+{
+    ProcessDeadline &deadline = processDeadlines[process->processNumber];
+    if (deadline.relativeDeadline == 0 || (deadline.period == 0 && process->remainingCpuTime > 0))
+        return;
+    int lateness = currentTime - deadline.absoluteDeadline;
+    deadline.jobs++;
+    deadline.misses += lateness > 0;
+    deadline.maxLateness = max(deadline.maxLateness, lateness);
+    deadline.totalLateness += lateness;
+}
+
+// A function to return whether a process returning from I/O has to wait for the release of its next job
+// A periodic process whose I/O ends before its next period waits in the WAITING state, which is neither I/O nor CPU wait
+bool waitsForRelease(Process *process, int currentTime)
+{
+    ProcessDeadline &deadline = processDeadlines[process->processNumber];
+    return deadline.period > 0 && process->arrivalTime + (long long)deadline.jobs * deadline.period > currentTime;
+}
+
+// A function to return the release time of the next job of a periodic process
+int getReleaseTime(Process *process)
+{
+    ProcessDeadline &deadline = processDeadlines[process->processNumber];
+    return (int)min(process->arrivalTime + (long long)deadline.jobs * deadline.period, (long long)INT_MAX);
+}
+
+// A function to release the next job of a periodic process when it returns from I/O or from waiting for its period
+void releaseJob(Process *process, int currentTime)
+{
+    ProcessDeadline &deadline = processDeadlines[process->processNumber];
+    if (deadline.period == 0)
+        return;
+    long long release = max((long long)currentTime, process->arrivalTime + (long long)deadline.jobs * deadline.period);
+    deadline.absoluteDeadline = min(release + deadline.relativeDeadline, (long long)INT_MAX);
+}
+
+// Functions to write and read values of a checkpoint file
+void writeCheckpointValue(FILE *file, int value)
+{
+    fwrite(&value, sizeof(int), 1, file);
+}
+
+int readCheckpointValue(FILE *file)
+{
+    int value = 0;
+    if (fread(&value, sizeof(int), 1, file) != 1)
     {
-        if (readyQueue.empty())
-            return NULL;
-        Process *process = readyQueue.front();
-        readyQueue.pop_front();
-        return process;
+        cout << "Error: Checkpoint file is truncated." << endl;
+        exit(1);
     }
+    return value;
+}
 
-    // Show the ready queue
-    void showReadyQueue()
+// A function to read a block of a checkpoint file written with fwrite
+void readCheckpointBlock(FILE *file, void *block, size_t size)
+{
+    if (fread(block, size, 1, file) != 1)
     {
-        if (readyQueue.empty())
-            cout << "SCHED (0): ";
-        else
-        {
-            cout << "SCHED (" << readyQueue.size() << "): ";
-            for (int i = 0; i < readyQueue.size(); i++)
-                cout << "(t=" << readyQueue[i]->stateTimeStamp << " pid=" << readyQueue[i]->processNumber << ") ";
-            cout << endl;
-        }
+        cout << "Error: Checkpoint file is truncated." << endl;
+        exit(1);
     }
-};
+}
 
-// A Priority Scheduler class
-class Priority : public Scheduler
+// Functions to write and read 64-bit values of a checkpoint file
+void writeCheckpointLongValue(FILE *file, long long value)
 {
-    // Initialise an active queue and an expired queue.
-    deque<Process *> *activeQueue;
-    deque<Process *> *expiredQueue;
+    fwrite(&value, sizeof(long long), 1, file);
+}
+
+long long readCheckpointLongValue(FILE *file)
+{
+    long long value = 0;
+    if (fread(&value, sizeof(long long), 1, file) != 1)
+    {
+        cout << "Error: Checkpoint file is truncated." << endl;
+        exit(1);
+    }
+    return value;
+}
+
+// A function to write a queue of processes to a checkpoint file as process numbers
+void writeProcessQueue(FILE *file, deque<Process *> &queue)
+{
+    writeCheckpointValue(file, queue.size());
+    for (int i = 0; i < queue.size(); i++)
+        writeCheckpointValue(file, queue[i]->processNumber);
+}
 
+// A function to read a queue of processes from a checkpoint file
+void readProcessQueue(FILE *file, deque<Process *> &queue)
+{
+    int size = readCheckpointValue(file);
+    queue.clear();
+    for (int i = 0; i < size; i++)
+        queue.push_back(processes[readCheckpointValue(file)]);
+}
+
+// A Scheduler class to store the scheduler information
+class Scheduler
+{
 public:
-    // Constructor to initialize the name of the scheduler, the quantum, and the maximum number of priorities
-    Priority(int quantum, int maxprios)
+    string name;                      // The name of the scheduler
+    int quantum = 10000;              // The quantum of the scheduler. Default value is 10K
+    int maxprios = 4;                 // The maximum number of priorities. Default value is 4
+    int ioTime = 0;                   // The time at least one process spent in I/O
+    int blockedProcesses = 0;         // The number of processes currently in I/O
+    int ioBusyStartTime = 0;          // The time at which the current I/O busy period started
+    int cpuTime = 0;                  // The time spent by CPU
+    virtual bool checkEventPreemption(Process *activatedProcess, Process *currentRunningProcess, int currentTime, bool showPreemptionDecision)
     {
-        name = "PRIO " + to_string(quantum);
-        this->quantum = quantum;
-        this->maxprios = maxprios;
-        activeQueue = new deque<Process *>[maxprios];
-        expiredQueue = new deque<Process *>[maxprios];
+        // A function to test if the current process should be preempt the running process
+        // Default implementation is to return false
+        return false;
     }
-    // Add a process to the active queue based on the dynamic priority
-    void addProcess(Process *process)
+    virtual int getTimeslice(Process *process)
     {
-        if (process->dynamicPriority <= -1)
+        // A function to return the time the process may run before it is preempted
+        // Default implementation is to return the quantum
+        return quantum;
+    }
+    virtual void chargeCpuTime(Process *process, int time)
+    {
+        // A function to account the time a process ran when it leaves the CPU
+        // Default implementation is to do nothing
+    }
+    virtual void addProcess(Process *process) = 0; // A function to add a process to the ready queue
+    virtual Process *getNextProcess() = 0;         // A function to get the next process from the ready queue
+    virtual void showReadyQueue() = 0;             // A function to show the ready queue
+    virtual void writeCheckpoint(FILE *file) = 0;  // A function to write the ready queue to a checkpoint file
+    virtual void readCheckpoint(FILE *file) = 0;   // A function to read the ready queue from a checkpoint file
+    virtual void releaseProcessesBefore(int processNumber)
+    {
+        // A function to drop the state kept for the processes summarized in streaming mode
+        // Default implementation is to do nothing
+    }
+    virtual void migrateProcess(Process *process, Scheduler *source)
+    {
+        // A function to take over the state of a process moving from the scheduler of another CPU
+        // Default implementation is to do nothing
+    }
+};
+
+// A queue to store the events, implemented as a vector for inserting events in order of the timestamp
+// Events are popped by advancing eventQueueHead, and the popped events of a time stamp are removed from the
+// vector in one batch when the first event of the next time stamp is popped
+vector<Event *> eventQueue;
+int eventQueueHead = 0;      // The position of the next event to pop
+int lastEventTimeStamp = -1; // The time stamp of the last popped event
+
+// A CalendarEntry class to store an event in a bucket of the calendar queue
+class CalendarEntry
+{
+public:
+    int timeStamp;      // The time stamp of the event
+    long long sequence; // The insertion order among events with equal time stamps
+    Event *event;       // The event
+};
+
+// A function to test if a calendar entry is popped before another one
+bool isEarlierCalendarEntry(const CalendarEntry &first, const CalendarEntry &second)
+{
+    return first.timeStamp < second.timeStamp || (first.timeStamp == second.timeStamp && first.sequence < second.sequence);
+}
+
+// A CalendarQueue class to store the events in buckets by time, as an alternative to the sorted vector
+// The buckets form a year of bucketWidth time units each, and an event goes to the bucket of its time modulo
+// the year. Each bucket is sorted, and the events are popped by walking the buckets of the current year.
+// The number of buckets follows the number of events and the width follows their spacing, so that adding
+// and popping an event take amortized constant time
+class CalendarQueue
+{
+public:
+    vector<deque<CalendarEntry>> buckets; // The buckets, a power of two of them
+    int bucketWidth = 1;                  // The time covered by a bucket
+    int size = 0;                         // The number of events in the queue
+    int currentBucket = 0;                // The bucket holding the window the next event is searched from
+    long long bucketTop = 1;              // The end of the time window of the current bucket
+    long long highSequence = 0;           // The sequence of the last event added after the events with equal time stamps
+    long long lowSequence = 0;            // The sequence of the last event added before the events with equal time stamps
+    ProcessTable<Event *> pendingEvents;  // The event of each process by process number, as a process has at most one
+
+    CalendarQueue()
+    {
+        buckets.resize(2);
+    }
+
+    // Return the bucket of a time stamp
+    int getBucket(int timeStamp)
+    {
+        return (timeStamp / bucketWidth) & (buckets.size() - 1);
+    }
+
+    // Move the current bucket to the window of a time stamp
+    void moveTo(int timeStamp)
+    {
+        currentBucket = getBucket(timeStamp);
+        bucketTop = ((long long)timeStamp / bucketWidth + 1) * bucketWidth;
+    }
+
+    // Insert an entry into its sorted bucket, searching from the back as new events are usually the latest.
+    // Returns the number of entries compared
+    int insertEntry(const CalendarEntry &entry)
+    {
+        deque<CalendarEntry> &bucket = buckets[getBucket(entry.timeStamp)];
+        int position = bucket.size();
+        while (position > 0 && isEarlierCalendarEntry(entry, bucket[position - 1]))
+            position--;
+        bucket.insert(bucket.begin() + position, entry);
+        return bucket.size() - position;
+    }
+
+    // Add an event. If beforeEqualTimeStamps is set, the event goes before the events with the same time stamp.
+    // Returns the number of entries compared
+    int add(Event *event, bool beforeEqualTimeStamps)
+    {
+        CalendarEntry entry = {event->timeStamp, beforeEqualTimeStamps ? --lowSequence : ++highSequence, event};
+        int probes = insertEntry(entry);
+        size++;
+        pendingEvents[event->process->processNumber] = event;
+        // An event before the window of the current bucket moves the search back to it
+        if (event->timeStamp < bucketTop - bucketWidth)
+            moveTo(event->timeStamp);
+        if (size > 2 * (int)buckets.size())
+            resize(2 * buckets.size());
+        return probes;
+    }
+
+    // Move the current bucket to the bucket holding the next event. The queue must not be empty
+    void locateNext()
+    {
+        // Walk the buckets of the current year until one has an event within its window
+        for (int i = 0; i < buckets.size(); i++)
         {
-            process->dynamicPriority = process->staticPriority - 1;
-            expiredQueue[process->dynamicPriority].push_back(process);
+            if (!buckets[currentBucket].empty() && buckets[currentBucket].front().timeStamp < bucketTop)
+                return;
+            currentBucket = (currentBucket + 1) & (buckets.size() - 1);
+            bucketTop += bucketWidth;
         }
-        else
-            activeQueue[process->dynamicPriority].push_back(process);
+        // No event within a year, so jump to the earliest event directly
+        CalendarEntry *earliest = nullptr;
+        for (int i = 0; i < buckets.size(); i++)
+            if (!buckets[i].empty() && (earliest == nullptr || isEarlierCalendarEntry(buckets[i].front(), *earliest)))
+                earliest = &buckets[i].front();
+        moveTo(earliest->timeStamp);
     }
 
-    // Get the next process from the active queue based on the dynamic priority
-    Process *getNextProcess()
+    // Return the next event without removing it
+    Event *peek()
     {
-        Process *process = NULL;
-        for (int i = maxprios - 1; i >= 0; i--)
+        if (size == 0)
+            return nullptr;
+        locateNext();
+        return buckets[currentBucket].front().event;
+    }
+
+    // Remove and return the next event
+    Event *pop()
+    {
+        if (size == 0)
+            return nullptr;
+        locateNext();
+        Event *event = buckets[currentBucket].front().event;
+        buckets[currentBucket].pop_front();
+        size--;
+        if (pendingEvents[event->process->processNumber] == event)
+            pendingEvents[event->process->processNumber] = nullptr;
+        if (buckets.size() > 2 && size < (int)buckets.size() / 2)
+            resize(buckets.size() / 2);
+        return event;
+    }
+
+    // Remove and return the event of a process, or nullptr if the process has no event
+    Event *cancel(Process *process)
+    {
+        if (pendingEvents[process->processNumber] == nullptr)
+            return nullptr;
+        Event *event = pendingEvents[process->processNumber];
+        deque<CalendarEntry> &bucket = buckets[getBucket(event->timeStamp)];
+        for (int i = 0; i < bucket.size(); i++)
         {
-            if (!activeQueue[i].empty())
+            if (bucket[i].event == event)
             {
-                process = activeQueue[i].front();
-                activeQueue[i].pop_front();
-                return process;
+                bucket.erase(bucket.begin() + i);
+                break;
             }
         }
-        // If no process is found in the active queue, swap the active and expired queues
-        deque<Process *> *temp = activeQueue;
-        activeQueue = expiredQueue;
-        expiredQueue = temp;
+        size--;
+        pendingEvents[process->processNumber] = nullptr;
+        return event;
+    }
 
-        // Find the next process in the active queue
-        for (int i = maxprios - 1; i >= 0; i--)
+    // Test if a process has an event at a time stamp
+    bool hasEvent(Process *process, int timeStamp)
+    {
+        return pendingEvents[process->processNumber] != nullptr &&
+               pendingEvents[process->processNumber]->timeStamp == timeStamp;
+    }
+
+    // Return all the entries in the order they are popped
+    vector<CalendarEntry> getOrderedEntries()
+    {
+        vector<CalendarEntry> entries;
+        for (int i = 0; i < buckets.size(); i++)
+            entries.insert(entries.end(), buckets[i].begin(), buckets[i].end());
+        sort(entries.begin(), entries.end(), isEarlierCalendarEntry);
+        return entries;
+    }
+
+    // Rebuild the queue with a new number of buckets, and a width of three times the average spacing of the
+    // next events. The events are popped in order, so every new bucket is filled by appending
+    void resize(int numBuckets)
+    {
+        vector<CalendarEntry> entries;
+        entries.reserve(size);
+        while (size > 0)
         {
-            if (!activeQueue[i].empty())
-            {
-                process = activeQueue[i].front();
-                activeQueue[i].pop_front();
-                return process;
-            }
+            locateNext();
+            entries.push_back(buckets[currentBucket].front());
+            buckets[currentBucket].pop_front();
+            size--;
         }
-        // Return NULL if no process is found
+        int samples = min((int)entries.size(), 25);
+        long long spacing = samples > 1 ? (entries[samples - 1].timeStamp - entries[0].timeStamp) / (samples - 1) : 0;
+        if (spacing == 0 && entries.size() > 1)
+            spacing = (entries.back().timeStamp - entries[0].timeStamp) / (long long)entries.size();
+        bucketWidth = max(1LL, 3 * spacing);
+        buckets.assign(numBuckets, deque<CalendarEntry>());
+        for (int i = 0; i < entries.size(); i++)
+            buckets[getBucket(entries[i].timeStamp)].push_back(entries[i]);
+        size = entries.size();
+        moveTo(entries.empty() ? 0 : entries[0].timeStamp);
+    }
+};
+
+// The calendar queue, selected with -q c. If it is not set, the events are kept in the sorted eventQueue vector
+CalendarQueue *calendarQueue = nullptr;
+
+// Initialize the scheduler object.
+Scheduler *scheduler = nullptr;
+
+// A function to test if a process has an event pending at the current time stamp
+bool isEventPending(Process *process, int currentTime)
+{
+    if (calendarQueue != nullptr)
+        return calendarQueue->hasEvent(process, currentTime);
+    for (int i = eventQueueHead; i < eventQueue.size(); i++)
+        if (eventQueue[i]->timeStamp == currentTime && eventQueue[i]->process->processNumber == process->processNumber)
+            return true;
+    return false;
+}
+
+// A function to remove the pending event of a process from the eventQueue and release it
+void cancelEvent(Process *process)
+{
+    if (calendarQueue != nullptr)
+    {
+        delete calendarQueue->cancel(process);
+        return;
+    }
+    for (int i = eventQueueHead; i < eventQueue.size(); i++)
+    {
+        if (eventQueue[i]->process->processNumber == process->processNumber)
+        {
+            delete eventQueue[i];
+            eventQueue.erase(eventQueue.begin() + i);
+            break;
+        }
+    }
+}
+
+// A function to return the events of the eventQueue in the order they are popped
+vector<Event *> getOrderedEvents()
+{
+    if (calendarQueue == nullptr)
+        return vector<Event *>(eventQueue.begin() + eventQueueHead, eventQueue.end());
+    vector<CalendarEntry> entries = calendarQueue->getOrderedEntries();
+    vector<Event *> events;
+    for (int i = 0; i < entries.size(); i++)
+        events.push_back(entries[i].event);
+    return events;
+}
+
+// A First Come First Serve (FCFS) Scheduler class
+class FCFS : public Scheduler
+{
+    deque<Process *> readyQueue; // The ready queue to store the processes
+public:
+    // Constructor to initialize the name of the scheduler
+    FCFS()
+    {
+        name = "FCFS";
+    }
+    // Add a process to the ready queue
+    void addProcess(Process *process)
+    {
+        readyQueue.push_back(process);
+    }
+
+    // Get the next process from the ready queue. The first process added is returned first
+    Process *getNextProcess()
+    {
+        if (readyQueue.empty())
+            return NULL;
+        Process *process = readyQueue.front();
+        readyQueue.pop_front();
         return process;
     }
 
     // Show the ready queue
     void showReadyQueue()
     {
-        int totalProcesses = 0;
-        for (int i = 0; i < maxprios; i++)
-            totalProcesses += activeQueue[i].size() + expiredQueue[i].size();
-        if (totalProcesses == 0)
-            cout << "SCHED (0): ";
-        else
+        showReadyQueueHeader(readyQueue.size());
+        if (!readyQueue.empty())
         {
-            cout << "SCHED (" << totalProcesses << "): ";
-            for (int i = maxprios - 1; i >= 0; i--)
-            {
-                for (int j = 0; j < activeQueue[i].size(); j++)
-                    cout << "(t=" << activeQueue[i][j]->stateTimeStamp << " pid=" << activeQueue[i][j]->processNumber << " prio=" << activeQueue[i][j]->dynamicPriority << " active) ";
-                for (int j = 0; j < expiredQueue[i].size(); j++)
-                    cout << "(t=" << expiredQueue[i][j]->stateTimeStamp << " pid=" << expiredQueue[i][j]->processNumber << " prio=" << expiredQueue[i][j]->dynamicPriority << ") expired) ";
-            }
-            cout << endl;
+            for (int i = 0; i < readyQueue.size(); i++)
+                showReadyQueueEntry(readyQueue[i]);
+            showEndLine();
         }
     }
+
+    // Write the ready queue to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        writeProcessQueue(file, readyQueue);
+    }
+
+    // Read the ready queue from a checkpoint file
+    void readCheckpoint(FILE *file)
+    {
+        readProcessQueue(file, readyQueue);
+    }
 };
 
-class PreemptivePriority : public Priority
+// A Last Come First Serve (LCFS) Scheduler class
+class LCFS : public Scheduler
 {
-
+    deque<Process *> readyQueue; // The ready queue to store the processes
 public:
-    // Constructor to initialize the name of the scheduler, the quantum, and the maximum number of priorities
-    // Since PreemptivePriority extends Priority, the constructor calls the constructor of the base class
-    PreemptivePriority(int quantum, int maxprios) : Priority(quantum, maxprios)
+    // Constructor to initialize the name of the scheduler
+    LCFS()
     {
-        name = "PREPRIO " + to_string(quantum);
+        name = "LCFS";
+    }
+    // Add a process to the ready queue
+    void addProcess(Process *process)
+    {
+        readyQueue.push_back(process);
     }
 
-    // Test if the current process should preempt the running process
-    bool checkEventPreemption(Process *activatedProcess, Process *currentRunningProcess, int currentTime, bool showPreemptionDecision) override
+    // Get the next process from the ready queue. The last process added is returned first
+    Process *getNextProcess()
     {
-        if (currentRunningProcess == nullptr)
-            return false; // No process is running, so no need to preempt
-        // Check if the dynamic priority of the activated process is higher than the dynamic priority of the currently running process
-        bool dynamicPriorityHigher = activatedProcess->dynamicPriority > currentRunningProcess->dynamicPriority;
-        // Check if the currently running process has an event pending for the current time stamp
-        bool eventPending = false;
-        for (int i = 0; i < eventQueue.size(); i++)
+        if (readyQueue.empty())
+            return NULL;
+        Process *process = readyQueue.back();
+        readyQueue.pop_back();
+        return process;
+    }
+
+    // Show the ready queue
+    void showReadyQueue()
+    {
+        showReadyQueueHeader(readyQueue.size());
+        if (!readyQueue.empty())
         {
-            if (eventQueue[i]->timeStamp == currentTime && eventQueue[i]->process->processNumber == currentRunningProcess->processNumber)
-            {
-                eventPending = true;
-                break;
-            }
+            for (int i = 0; i < readyQueue.size(); i++)
+                showReadyQueueEntry(readyQueue[i]);
+            showEndLine();
         }
-        // Preempt the process if the dynamic priority of the activated process is higher than the dynamic priority of the currently running process
-        bool preempt = dynamicPriorityHigher && !eventPending;
-        // Print the preemption decision if the showPreemptionDecision flag is set
-        if (showPreemptionDecision)
-            cout << "\t--> PrioPreempt activatedProcess.dynamicPriority > currentRunningProcess.dynamicPriority: " << dynamicPriorityHigher
-                 << " noEventPending: " << !eventPending
-                 << " Decision: " << (preempt ? "YES" : "NO") << endl;
-        return preempt;
+    }
+
+    // Write the ready queue to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        writeProcessQueue(file, readyQueue);
+    }
+
+    // Read the ready queue from a checkpoint file
+    void readCheckpoint(FILE *file)
+    {
+        readProcessQueue(file, readyQueue);
     }
 };
 
-// Variables to store random values and the random index offset
-int *randomValues;
-int MAX_RANDOM_VALUES_LENGTH;
-int randomIndexOffset = 0;
+// A Shortest Remaining Time First (SRTF) Scheduler class
+class SRTF : public Scheduler
+{
+    deque<Process *> readyQueue; // The ready queue to store the processes
+public:
+    // Constructor to initialize the name of the scheduler
+    SRTF()
+    {
+        name = "SRTF";
+    }
+    // Add a process to the ready queue
+    void addProcess(Process *process)
+    {
+        readyQueue.push_back(process);
+    }
+
+    // Get the next process from the ready queue. The process with the shortest remaining CPU time is returned first
+    Process *getNextProcess()
+    {
+        if (readyQueue.empty())
+            return NULL;
+        Process *shortestProcess = readyQueue.front();
+        for (int i = 1; i < readyQueue.size(); i++)
+        {
+            if (readyQueue[i]->remainingCpuTime < shortestProcess->remainingCpuTime)
+                shortestProcess = readyQueue[i];
+        }
+        readyQueue.erase(remove(readyQueue.begin(), readyQueue.end(), shortestProcess), readyQueue.end());
+        return shortestProcess;
+    }
+
+    // Show the ready queue
+    void showReadyQueue()
+    {
+        showReadyQueueHeader(readyQueue.size());
+        if (!readyQueue.empty())
+        {
+            for (int i = 0; i < readyQueue.size(); i++)
+                showReadyQueueEntry(readyQueue[i]);
+            showEndLine();
+        }
+    }
+
+    // Write the ready queue to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        writeProcessQueue(file, readyQueue);
+    }
+
+    // Read the ready queue from a checkpoint file
+    void readCheckpoint(FILE *file)
+    {
+        readProcessQueue(file, readyQueue);
+    }
+};
+
+// A Round Robin (RR) Scheduler class
+class RoundRobin : public Scheduler
+{
+    deque<Process *> readyQueue; // The ready queue to store the processes
+public:
+    // Constructor to initialize the name of the scheduler and the quantum
+    RoundRobin(int quantum)
+    {
+        name = "RR " + to_string(quantum);
+        this->quantum = quantum;
+    }
+    // Add a process to the ready queue
+    void addProcess(Process *process)
+    {
+        readyQueue.push_back(process);
+    }
+
+    // Get the next process from the ready queue. The process is returned in a round-robin fashion based on the quantum.
+    Process *getNextProcess()
+    {
+        if (readyQueue.empty())
+            return NULL;
+        Process *process = readyQueue.front();
+        readyQueue.pop_front();
+        return process;
+    }
+
+    // Show the ready queue
+    void showReadyQueue()
+    {
+        showReadyQueueHeader(readyQueue.size());
+        if (!readyQueue.empty())
+        {
+            for (int i = 0; i < readyQueue.size(); i++)
+                showReadyQueueEntry(readyQueue[i]);
+            showEndLine();
+        }
+    }
+
+    // Write the ready queue to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        writeProcessQueue(file, readyQueue);
+    }
+
+    // Read the ready queue from a checkpoint file
+    void readCheckpoint(FILE *file)
+    {
+        readProcessQueue(file, readyQueue);
+    }
+};
+
+// A Priority Scheduler class
+class Priority : public Scheduler
+{
+    // Initialise an active queue and an expired queue.
+    deque<Process *> *activeQueue;
+    deque<Process *> *expiredQueue;
+
+public:
+    // Constructor to initialize the name of the scheduler, the quantum, and the maximum number of priorities
+    Priority(int quantum, int maxprios)
+    {
+        name = "PRIO " + to_string(quantum);
+        this->quantum = quantum;
+        this->maxprios = maxprios;
+        activeQueue = new deque<Process *>[maxprios];
+        expiredQueue = new deque<Process *>[maxprios];
+    }
+    // Add a process to the active queue based on the dynamic priority
+    void addProcess(Process *process)
+    {
+        if (process->dynamicPriority <= -1)
+        {
+            process->dynamicPriority = process->staticPriority - 1;
+            expiredQueue[process->dynamicPriority].push_back(process);
+        }
+        else
+            activeQueue[process->dynamicPriority].push_back(process);
+    }
+
+    // Get the next process from the active queue based on the dynamic priority
+    Process *getNextProcess()
+    {
+        Process *process = NULL;
+        for (int i = maxprios - 1; i >= 0; i--)
+        {
+            if (!activeQueue[i].empty())
+            {
+                process = activeQueue[i].front();
+                activeQueue[i].pop_front();
+                return process;
+            }
+        }
+        // If no process is found in the active queue, swap the active and expired queues
+        deque<Process *> *temp = activeQueue;
+        activeQueue = expiredQueue;
+        expiredQueue = temp;
+
+        // Find the next process in the active queue
+        for (int i = maxprios - 1; i >= 0; i--)
+        {
+            if (!activeQueue[i].empty())
+            {
+                process = activeQueue[i].front();
+                activeQueue[i].pop_front();
+                return process;
+            }
+        }
+        // Return NULL if no process is found
+        return process;
+    }
+
+    // Show the ready queue
+    void showReadyQueue()
+    {
+        int totalProcesses = 0;
+        for (int i = 0; i < maxprios; i++)
+            totalProcesses += activeQueue[i].size() + expiredQueue[i].size();
+        showReadyQueueHeader(totalProcesses);
+        if (totalProcesses != 0)
+        {
+            for (int i = maxprios - 1; i >= 0; i--)
+            {
+                for (int j = 0; j < activeQueue[i].size(); j++)
+                    showReadyQueueEntry(activeQueue[i][j], ACTIVE_ENTRY);
+                for (int j = 0; j < expiredQueue[i].size(); j++)
+                    showReadyQueueEntry(expiredQueue[i][j], EXPIRED_ENTRY);
+            }
+            showEndLine();
+        }
+    }
+
+    // Write the active and expired queues to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        for (int i = 0; i < maxprios; i++)
+        {
+            writeProcessQueue(file, activeQueue[i]);
+            writeProcessQueue(file, expiredQueue[i]);
+        }
+    }
+
+    // Read the active and expired queues from a checkpoint file
+    void readCheckpoint(FILE *file)
+    {
+        for (int i = 0; i < maxprios; i++)
+        {
+            readProcessQueue(file, activeQueue[i]);
+            readProcessQueue(file, expiredQueue[i]);
+        }
+    }
+};
+
+class PreemptivePriority : public Priority
+{
+
+public:
+    // Constructor to initialize the name of the scheduler, the quantum, and the maximum number of priorities
+    // Since PreemptivePriority extends Priority, the constructor calls the constructor of the base class
+    PreemptivePriority(int quantum, int maxprios) : Priority(quantum, maxprios)
+    {
+        name = "PREPRIO " + to_string(quantum);
+    }
+
+    // Test if the current process should preempt the running process
+    bool checkEventPreemption(Process *activatedProcess, Process *currentRunningProcess, int currentTime, bool showPreemptionDecision) override
+    {
+        if (currentRunningProcess == nullptr)
+            return false; // No process is running, so no need to preempt
+        // Check if the dynamic priority of the activated process is higher than the dynamic priority of the currently running process
+        bool dynamicPriorityHigher = activatedProcess->dynamicPriority > currentRunningProcess->dynamicPriority;
+        // Check if the currently running process has an event pending for the current time stamp
+        bool eventPending = isEventPending(currentRunningProcess, currentTime);
+        // Preempt the process if the dynamic priority of the activated process is higher than the dynamic priority of the currently running process
+        bool preempt = dynamicPriorityHigher && !eventPending;
+        // Print the preemption decision if the showPreemptionDecision flag is set
+        if (showPreemptionDecision)
+            emitTraceRecord(TRACE_PREEMPTION, PRIORITY_PREEMPTION, 0, 0, dynamicPriorityHigher, !eventPending, preempt);
+        return preempt;
+    }
+};
+
+// The load weights of the static priorities for the CFS scheduler, taken from the Linux nice levels 0 to -20
+// Each priority level receives about 25% more CPU time than the level below it
+const int CFS_PRIORITY_WEIGHTS[] = {1024, 1277, 1586, 1991, 2501, 3121, 3906, 4904, 6100, 7620, 9548,
+                                    11916, 14949, 18705, 23254, 29154, 36291, 46273, 56483, 71755, 88761};
+const int CFS_NUM_PRIORITY_WEIGHTS = sizeof(CFS_PRIORITY_WEIGHTS) / sizeof(int);
+const int CFS_NICE_0_WEIGHT = 1024;          // The weight at which the virtual runtime advances with real time
+const int CFS_VIRTUAL_RUNTIME_SCALE = 1024;  // Virtual runtimes are kept in 1/1024 time units so short bursts are not truncated
+const int CFS_DEFAULT_TARGET_LATENCY = 20;   // The default period in which every ready process runs once
+
+// A Completely Fair Scheduler (CFS) class
+// The ready processes are kept in a red-black tree (std::multimap) ordered by their virtual runtime, which
+// advances inversely to the weight of the static priority. The process with the lowest virtual runtime runs
+// next, for a timeslice that is its share by weight of the target latency
+class CompletelyFairScheduler : public Scheduler
+{
+    multimap<long long, Process *> readyTree;    // The ready processes ordered by virtual runtime, equal keys in insertion order
+    ProcessTable<long long> virtualRuntimes{-1}; // The virtual runtime of each process by process number, -1 if not yet known
+    long long minVirtualRuntime = 0;             // The monotonically increasing minimum virtual runtime of the ready processes
+    long long readyWeight = 0;                   // The total weight of the ready processes
+    int targetLatency;                           // The period in which every ready process runs once
+    int minGranularity;                          // The minimum timeslice, which stretches the period when many processes are ready
+
+    // Return the weight of a process based on its static priority
+    int getWeight(Process *process)
+    {
+        return CFS_PRIORITY_WEIGHTS[min(max(process->staticPriority - 1, 0), CFS_NUM_PRIORITY_WEIGHTS - 1)];
+    }
+
+    // Return the virtual runtime of a process. A process not seen before starts at the minimum virtual runtime
+    long long &getVirtualRuntime(Process *process)
+    {
+        long long &virtualRuntime = virtualRuntimes[process->processNumber];
+        if (virtualRuntime < 0)
+            virtualRuntime = minVirtualRuntime;
+        return virtualRuntime;
+    }
+
+    // Place a process becoming ready. A process returning from I/O keeps at most half a target latency of credit,
+    // so that a long sleep does not let it monopolise the CPU
+    long long placeProcess(Process *process)
+    {
+        long long &virtualRuntime = getVirtualRuntime(process);
+        virtualRuntime = max(virtualRuntime, minVirtualRuntime - (long long)targetLatency * CFS_VIRTUAL_RUNTIME_SCALE / 2);
+        return virtualRuntime;
+    }
+
+    // Convert the real time a process ran to virtual runtime
+    long long toVirtualRuntime(Process *process, int time)
+    {
+        return (long long)time * CFS_VIRTUAL_RUNTIME_SCALE * CFS_NICE_0_WEIGHT / getWeight(process);
+    }
+
+public:
+    // Constructor to initialize the name of the scheduler, the target latency, and the maximum number of priorities
+    CompletelyFairScheduler(int targetLatency, int maxprios)
+    {
+        name = "CFS " + to_string(targetLatency);
+        this->targetLatency = targetLatency;
+        this->maxprios = maxprios;
+        minGranularity = max(1, targetLatency / 8);
+    }
+
+    // Add a process to the ready tree based on its virtual runtime
+    void addProcess(Process *process)
+    {
+        readyTree.insert(make_pair(placeProcess(process), process));
+        readyWeight += getWeight(process);
+    }
+
+    // Get the next process from the ready tree. The process with the lowest virtual runtime is returned first
+    Process *getNextProcess()
+    {
+        if (readyTree.empty())
+            return NULL;
+        multimap<long long, Process *>::iterator leftmost = readyTree.begin();
+        Process *process = leftmost->second;
+        minVirtualRuntime = max(minVirtualRuntime, leftmost->first);
+        readyWeight -= getWeight(process);
+        readyTree.erase(leftmost);
+        return process;
+    }
+
+    // Return the timeslice of a process as its share by weight of the period, which is the target latency
+    // unless so many processes are ready that they would get less than the minimum granularity
+    int getTimeslice(Process *process)
+    {
+        long long numRunnable = readyTree.size() + 1;
+        long long period = targetLatency;
+        if (numRunnable * minGranularity > targetLatency)
+            period = numRunnable * minGranularity;
+        long long timeslice = period * getWeight(process) / (readyWeight + getWeight(process));
+        return max((long long)minGranularity, timeslice);
+    }
+
+    // Advance the virtual runtime of a process by the time it ran
+    void chargeCpuTime(Process *process, int time)
+    {
+        getVirtualRuntime(process) += toVirtualRuntime(process, time);
+    }
+
+    // Test if the activated process should preempt the running process, which it does when the virtual runtime
+    // of the running process is ahead of that of the activated process by more than the minimum granularity
+    bool checkEventPreemption(Process *activatedProcess, Process *currentRunningProcess, int currentTime, bool showPreemptionDecision) override
+    {
+        if (currentRunningProcess == nullptr)
+            return false; // No process is running, so no need to preempt
+        // The virtual runtime of the running process includes the time it has run so far
+        long long runningVirtualRuntime = getVirtualRuntime(currentRunningProcess) +
+                                          toVirtualRuntime(currentRunningProcess, currentTime - currentRunningProcess->stateTimeStamp);
+        bool virtualRuntimeLower = runningVirtualRuntime - placeProcess(activatedProcess) > (long long)minGranularity * CFS_VIRTUAL_RUNTIME_SCALE;
+        // Check if the currently running process has an event pending for the current time stamp
+        bool eventPending = isEventPending(currentRunningProcess, currentTime);
+        bool preempt = virtualRuntimeLower && !eventPending;
+        // Print the preemption decision if the showPreemptionDecision flag is set
+        if (showPreemptionDecision)
+            emitTraceRecord(TRACE_PREEMPTION, VIRTUAL_RUNTIME_PREEMPTION, 0, 0, virtualRuntimeLower, !eventPending, preempt);
+        return preempt;
+    }
+
+    // Show the ready tree in order of virtual runtime
+    void showReadyQueue()
+    {
+        showReadyQueueHeader(readyTree.size());
+        if (!readyTree.empty())
+        {
+            for (multimap<long long, Process *>::iterator it = readyTree.begin(); it != readyTree.end(); ++it)
+                showReadyQueueEntry(it->second);
+            showEndLine();
+        }
+    }
+
+    // Write the virtual runtimes and the ready tree to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        writeCheckpointLongValue(file, minVirtualRuntime);
+        writeCheckpointValue(file, virtualRuntimes.end());
+        for (int i = 0; i < virtualRuntimes.end(); i++)
+            writeCheckpointLongValue(file, virtualRuntimes[i]);
+        writeCheckpointValue(file, readyTree.size());
+        for (multimap<long long, Process *>::iterator it = readyTree.begin(); it != readyTree.end(); ++it)
+            writeCheckpointValue(file, it->second->processNumber);
+    }
+
+    // Read the virtual runtimes and the ready tree from a checkpoint file
+    // Processes are inserted in tree order, so processes with equal virtual runtimes keep their order
+    void readCheckpoint(FILE *file)
+    {
+        minVirtualRuntime = readCheckpointLongValue(file);
+        int numVirtualRuntimes = readCheckpointValue(file);
+        for (int i = 0; i < numVirtualRuntimes; i++)
+            virtualRuntimes[i] = readCheckpointLongValue(file);
+        readyTree.clear();
+        readyWeight = 0;
+        int size = readCheckpointValue(file);
+        for (int i = 0; i < size; i++)
+        {
+            Process *process = processes[readCheckpointValue(file)];
+            readyTree.insert(make_pair(virtualRuntimes[process->processNumber], process));
+            readyWeight += getWeight(process);
+        }
+    }
+
+    // Drop the virtual runtimes of the processes summarized in streaming mode
+    void releaseProcessesBefore(int processNumber)
+    {
+        virtualRuntimes.releaseBefore(processNumber);
+    }
+
+    // Take over a process from the CPU of another CFS scheduler. Each CPU advances its own minimum virtual
+    // runtime, so the process keeps its lag behind the minimum of the source rather than its raw virtual runtime
+    void migrateProcess(Process *process, Scheduler *source)
+    {
+        CompletelyFairScheduler *sourceScheduler = static_cast<CompletelyFairScheduler *>(source);
+        long long lag = sourceScheduler->getVirtualRuntime(process) - sourceScheduler->minVirtualRuntime;
+        getVirtualRuntime(process) = minVirtualRuntime + lag;
+    }
+};
+
+// The numerator of the stride, large so that the strides of processes with many tickets stay precise
+const long long STRIDE_ONE = 1 << 20;
+
+// A StrideEntry class to store a process in the ready heap of the STRIDE scheduler
+class StrideEntry
+{
+public:
+    long long pass;     // The pass value of the process when it was added
+    long long sequence; // The order in which the process was added, to keep equal pass values in FIFO order
+    Process *process;   // The process
+};
+
+// A function to test if a stride entry is selected before another one
+bool isEarlierStrideEntry(const StrideEntry &first, const StrideEntry &second)
+{
+    return first.pass < second.pass || (first.pass == second.pass && first.sequence < second.sequence);
+}
+
+// A function to order stride entries so that the standard heap functions build a min-heap
+bool isLaterStrideEntry(const StrideEntry &first, const StrideEntry &second)
+{
+    return isEarlierStrideEntry(second, first);
+}
+
+// A Stride Scheduler class
+// Each process advances its pass value by its stride, which is inversely proportional to its tickets,
+// for every time unit it runs. The process with the lowest pass value, kept at the top of a min-heap, runs next
+class StrideScheduler : public Scheduler
+{
+    vector<StrideEntry> readyHeap;      // The ready processes as a min-heap on the pass value
+    ProcessTable<long long> passes{-1}; // The pass value of each process by process number, -1 if not yet known
+    long long globalPass = 0;           // The pass value of the last selected process
+    long long nextSequence = 0;         // The sequence number of the next added process
+
+    // Return the pass value of a process. A process not seen before starts at the global pass value
+    long long &getPass(Process *process)
+    {
+        long long &pass = passes[process->processNumber];
+        if (pass < 0)
+            pass = globalPass;
+        return pass;
+    }
+
+public:
+    // Constructor to initialize the name of the scheduler, the quantum, and the maximum number of priorities
+    StrideScheduler(int quantum, int maxprios)
+    {
+        name = "STRIDE " + to_string(quantum);
+        this->quantum = quantum;
+        this->maxprios = maxprios;
+    }
+
+    // Add a process to the ready heap. A process returning from I/O does not keep credit for the time it slept
+    void addProcess(Process *process)
+    {
+        long long &pass = getPass(process);
+        pass = max(pass, globalPass);
+        StrideEntry entry = {pass, nextSequence++, process};
+        readyHeap.push_back(entry);
+        push_heap(readyHeap.begin(), readyHeap.end(), isLaterStrideEntry);
+    }
+
+    // Get the next process from the ready heap. The process with the lowest pass value is returned first
+    Process *getNextProcess()
+    {
+        if (readyHeap.empty())
+            return NULL;
+        pop_heap(readyHeap.begin(), readyHeap.end(), isLaterStrideEntry);
+        StrideEntry entry = readyHeap.back();
+        readyHeap.pop_back();
+        globalPass = max(globalPass, entry.pass);
+        return entry.process;
+    }
+
+    // Advance the pass value of a process by its stride for every time unit it ran
+    void chargeCpuTime(Process *process, int time)
+    {
+        getPass(process) += time * (STRIDE_ONE / getTickets(process));
+    }
+
+    // Show the ready heap in the order the processes are selected
+    void showReadyQueue()
+    {
+        showReadyQueueHeader(readyHeap.size());
+        if (!readyHeap.empty())
+        {
+            vector<StrideEntry> entries = readyHeap;
+            sort(entries.begin(), entries.end(), isEarlierStrideEntry);
+            for (int i = 0; i < entries.size(); i++)
+                showReadyQueueEntry(entries[i].process);
+            showEndLine();
+        }
+    }
+
+    // Write the pass values and the ready heap to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        writeCheckpointLongValue(file, globalPass);
+        writeCheckpointLongValue(file, nextSequence);
+        writeCheckpointValue(file, passes.end());
+        for (int i = 0; i < passes.end(); i++)
+            writeCheckpointLongValue(file, passes[i]);
+        writeCheckpointValue(file, readyHeap.size());
+        for (int i = 0; i < readyHeap.size(); i++)
+        {
+            writeCheckpointLongValue(file, readyHeap[i].pass);
+            writeCheckpointLongValue(file, readyHeap[i].sequence);
+            writeCheckpointValue(file, readyHeap[i].process->processNumber);
+        }
+    }
+
+    // Read the pass values and the ready heap from a checkpoint file, keeping the heap layout
+    void readCheckpoint(FILE *file)
+    {
+        globalPass = readCheckpointLongValue(file);
+        nextSequence = readCheckpointLongValue(file);
+        int numPasses = readCheckpointValue(file);
+        for (int i = 0; i < numPasses; i++)
+            passes[i] = readCheckpointLongValue(file);
+        readyHeap.resize(readCheckpointValue(file));
+        for (int i = 0; i < readyHeap.size(); i++)
+        {
+            readyHeap[i].pass = readCheckpointLongValue(file);
+            readyHeap[i].sequence = readCheckpointLongValue(file);
+            readyHeap[i].process = processes[readCheckpointValue(file)];
+        }
+    }
+
+    // Drop the pass values of the processes summarized in streaming mode
+    void releaseProcessesBefore(int processNumber)
+    {
+        passes.releaseBefore(processNumber);
+    }
+
+    // Take over a process from the CPU of another STRIDE scheduler. Each CPU advances its own global pass,
+    // so the process keeps its lead over the global pass of the source rather than its raw pass value
+    void migrateProcess(Process *process, Scheduler *source)
+    {
+        StrideScheduler *sourceScheduler = static_cast<StrideScheduler *>(source);
+        long long lead = sourceScheduler->getPass(process) - sourceScheduler->globalPass;
+        getPass(process) = globalPass + lead;
+    }
+};
+
+// A DeadlineEntry class to store a process in the ready heap of the EDF scheduler
+class DeadlineEntry
+{
+public:
+    int deadline;       // The absolute deadline of the process when it was added
+    long long sequence; // The order in which the process was added, to keep equal deadlines in FIFO order
+    Process *process;   // The process
+};
+
+// A function to test if a deadline entry is selected before another one
+bool isEarlierDeadlineEntry(const DeadlineEntry &first, const DeadlineEntry &second)
+{
+    return first.deadline < second.deadline || (first.deadline == second.deadline && first.sequence < second.sequence);
+}
+
+// A function to order deadline entries so that the standard heap functions build a min-heap
+bool isLaterDeadlineEntry(const DeadlineEntry &first, const DeadlineEntry &second)
+{
+    return isEarlierDeadlineEntry(second, first);
+}
+
+// An Earliest Deadline First (EDF) Scheduler class
+// The ready processes are kept in a min-heap on the absolute deadline of their current job, and a process
+// becoming ready preempts a running process with a later deadline. Processes without a deadline run last
+class EarliestDeadlineFirst : public Scheduler
+{
+    vector<DeadlineEntry> readyHeap; // The ready processes as a min-heap on the absolute deadline
+    long long nextSequence = 0;      // The sequence number of the next added process
+
+public:
+    // Constructor to initialize the name of the scheduler, the quantum, and the maximum number of priorities
+    EarliestDeadlineFirst(int quantum, int maxprios)
+    {
+        name = "EDF " + to_string(quantum);
+        this->quantum = quantum;
+        this->maxprios = maxprios;
+    }
+
+    // Add a process to the ready heap based on its absolute deadline
+    void addProcess(Process *process)
+    {
+        DeadlineEntry entry = {getDeadline(process), nextSequence++, process};
+        readyHeap.push_back(entry);
+        push_heap(readyHeap.begin(), readyHeap.end(), isLaterDeadlineEntry);
+    }
+
+    // Get the next process from the ready heap. The process with the earliest deadline is returned first
+    Process *getNextProcess()
+    {
+        if (readyHeap.empty())
+            return NULL;
+        pop_heap(readyHeap.begin(), readyHeap.end(), isLaterDeadlineEntry);
+        Process *process = readyHeap.back().process;
+        readyHeap.pop_back();
+        return process;
+    }
+
+    // Test if the activated process should preempt the running process, which it does when its deadline is earlier
+    bool checkEventPreemption(Process *activatedProcess, Process *currentRunningProcess, int currentTime, bool showPreemptionDecision) override
+    {
+        if (currentRunningProcess == nullptr)
+            return false; // No process is running, so no need to preempt
+        bool deadlineEarlier = getDeadline(activatedProcess) < getDeadline(currentRunningProcess);
+        // Check if the currently running process has an event pending for the current time stamp
+        bool eventPending = isEventPending(currentRunningProcess, currentTime);
+        bool preempt = deadlineEarlier && !eventPending;
+        // Print the preemption decision if the showPreemptionDecision flag is set
+        if (showPreemptionDecision)
+            emitTraceRecord(TRACE_PREEMPTION, DEADLINE_PREEMPTION, 0, 0, deadlineEarlier, !eventPending, preempt);
+        return preempt;
+    }
+
+    // Show the ready heap in the order the processes are selected
+    void showReadyQueue()
+    {
+        showReadyQueueHeader(readyHeap.size());
+        if (!readyHeap.empty())
+        {
+            vector<DeadlineEntry> entries = readyHeap;
+            sort(entries.begin(), entries.end(), isEarlierDeadlineEntry);
+            for (int i = 0; i < entries.size(); i++)
+                showReadyQueueEntry(entries[i].process);
+            showEndLine();
+        }
+    }
+
+    // Write the ready heap to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        writeCheckpointLongValue(file, nextSequence);
+        writeCheckpointValue(file, readyHeap.size());
+        for (int i = 0; i < readyHeap.size(); i++)
+        {
+            writeCheckpointValue(file, readyHeap[i].deadline);
+            writeCheckpointLongValue(file, readyHeap[i].sequence);
+            writeCheckpointValue(file, readyHeap[i].process->processNumber);
+        }
+    }
+
+    // Read the ready heap from a checkpoint file, keeping the heap layout
+    void readCheckpoint(FILE *file)
+    {
+        nextSequence = readCheckpointLongValue(file);
+        readyHeap.resize(readCheckpointValue(file));
+        for (int i = 0; i < readyHeap.size(); i++)
+        {
+            readyHeap[i].deadline = readCheckpointValue(file);
+            readyHeap[i].sequence = readCheckpointLongValue(file);
+            readyHeap[i].process = processes[readCheckpointValue(file)];
+        }
+    }
+};
+
+// The random number generator is shared with the simulation, which draws the bursts from the same stream
+int randomNumberGenerator(int burst);
+
+// A Lottery Scheduler class
+// Every ready process occupies a slot of a Fenwick tree over the ticket counts, so that the total number of
+// tickets, adding or removing a process, and finding the winner of a drawn ticket all take logarithmic time
+class LotteryScheduler : public Scheduler
+{
+    vector<int> ticketTree;          // The Fenwick tree of the ticket counts of the slots, indexed from 1
+    vector<Process *> slotProcesses; // The process in each slot, nullptr if the slot is free
+    vector<int> freeSlots;           // The free slots below the end of slotProcesses, reused last in first out
+    int capacity = 0;                // The number of slots the Fenwick tree covers, a power of two
+    int totalTickets = 0;            // The total number of tickets of the ready processes
+    int numReadyProcesses = 0;       // The number of ready processes
+
+    // Add a number of tickets to a slot of the Fenwick tree
+    void updateTickets(int slot, int tickets)
+    {
+        for (int i = slot + 1; i <= capacity; i += i & -i)
+            ticketTree[i] += tickets;
+    }
+
+    // Find the slot holding a ticket, counting the tickets of the slots in order
+    int findSlot(int ticket)
+    {
+        int position = 0;
+        for (int step = capacity; step > 0; step >>= 1)
+        {
+            if (position + step <= capacity && ticketTree[position + step] <= ticket)
+            {
+                position += step;
+                ticket -= ticketTree[position];
+            }
+        }
+        return position;
+    }
+
+    // Rebuild the Fenwick tree for a new capacity from the processes in the slots
+    void rebuildTicketTree(int newCapacity)
+    {
+        capacity = newCapacity;
+        ticketTree.assign(capacity + 1, 0);
+        for (int i = 0; i < slotProcesses.size(); i++)
+            if (slotProcesses[i] != nullptr)
+                updateTickets(i, getTickets(slotProcesses[i]));
+    }
+
+public:
+    // Constructor to initialize the name of the scheduler, the quantum, and the maximum number of priorities
+    LotteryScheduler(int quantum, int maxprios)
+    {
+        name = "LOTTERY " + to_string(quantum);
+        this->quantum = quantum;
+        this->maxprios = maxprios;
+    }
+
+    // Add a process to a free slot, doubling the capacity of the Fenwick tree when it is full
+    void addProcess(Process *process)
+    {
+        int slot;
+        if (!freeSlots.empty())
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+            slotProcesses[slot] = process;
+        }
+        else
+        {
+            slot = slotProcesses.size();
+            if (slot == capacity)
+                rebuildTicketTree(max(1, 2 * capacity));
+            slotProcesses.push_back(process);
+        }
+        updateTickets(slot, getTickets(process));
+        totalTickets += getTickets(process);
+        numReadyProcesses++;
+    }
+
+    // Get the next process by drawing a winning ticket from the random values
+    Process *getNextProcess()
+    {
+        if (numReadyProcesses == 0)
+            return NULL;
+        int slot = findSlot(randomNumberGenerator(totalTickets) - 1);
+        Process *process = slotProcesses[slot];
+        updateTickets(slot, -getTickets(process));
+        totalTickets -= getTickets(process);
+        numReadyProcesses--;
+        slotProcesses[slot] = nullptr;
+        freeSlots.push_back(slot);
+        return process;
+    }
+
+    // Show the ready processes in slot order
+    void showReadyQueue()
+    {
+        showReadyQueueHeader(numReadyProcesses);
+        if (numReadyProcesses != 0)
+        {
+            for (int i = 0; i < slotProcesses.size(); i++)
+                if (slotProcesses[i] != nullptr)
+                    showReadyQueueEntry(slotProcesses[i]);
+            showEndLine();
+        }
+    }
+
+    // Write the slots and the free slots to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        writeCheckpointValue(file, slotProcesses.size());
+        for (int i = 0; i < slotProcesses.size(); i++)
+            writeCheckpointValue(file, slotProcesses[i] != nullptr ? slotProcesses[i]->processNumber : -1);
+        writeCheckpointValue(file, freeSlots.size());
+        for (int i = 0; i < freeSlots.size(); i++)
+            writeCheckpointValue(file, freeSlots[i]);
+    }
+
+    // Read the slots and the free slots from a checkpoint file and rebuild the Fenwick tree
+    void readCheckpoint(FILE *file)
+    {
+        slotProcesses.resize(readCheckpointValue(file));
+        totalTickets = 0;
+        numReadyProcesses = 0;
+        for (int i = 0; i < slotProcesses.size(); i++)
+        {
+            int processNumber = readCheckpointValue(file);
+            slotProcesses[i] = processNumber != -1 ? processes[processNumber] : nullptr;
+            if (slotProcesses[i] != nullptr)
+            {
+                totalTickets += getTickets(slotProcesses[i]);
+                numReadyProcesses++;
+            }
+        }
+        freeSlots.resize(readCheckpointValue(file));
+        for (int i = 0; i < freeSlots.size(); i++)
+            freeSlots[i] = readCheckpointValue(file);
+        int newCapacity = 1;
+        while (newCapacity < slotProcesses.size())
+            newCapacity *= 2;
+        rebuildTicketTree(newCapacity);
+    }
+};
+
+// A variable to store the random index offset into the random values of randomfile.h
+int randomIndexOffset = 0;
+
+// A CPU class to store the per-CPU information for multi-CPU simulation
+class Cpu
+{
+public:
+    int cpuNumber;                     // The CPU number
+    Scheduler *scheduler;              // The scheduler holding the ready queue of the CPU
+    Process *runningProcess = nullptr; // The process currently running on the CPU
+    int readyQueueLength = 0;          // The number of processes in the ready queue of the CPU
+    int busyTime = 0;                  // The time spent by the CPU running processes
+    int migrations = 0;                // The number of processes migrated to the CPU from another CPU
+    int lastProcessNumber = -1;        // The process last dispatched on the CPU, -1 if none
+    int dispatchEndTime = 0;           // The time at which the current dispatch completes and the process starts running
+    int overheadTime = 0;              // The time spent by the CPU dispatching and switching processes
+    int dispatches = 0;                // The number of processes dispatched on the CPU
+    int processSwitches = 0;           // The number of dispatches of a different process than the last one
+};
+
+// Variables to store the cost model of dispatching a process on a CPU, set with -o <dispatch>[:<switch>]
+// Every dispatch costs dispatchCost, and a dispatch of a different process than the one the CPU last ran costs
+// switchCost on top, for the cache and TLB refill. The CPU is reserved for the process during the overhead,
+// which the process spends in the ready state
+int dispatchCost = 0;
+int switchCost = 0;
+
+// A vector to store the CPUs. The scheduler of the first CPU also keeps the global I/O and CPU accounting
+vector<Cpu> cpus;
+
+// A function to return the load of a CPU as the number of ready and running processes
+int getCpuLoad(int cpuNumber)
+{
+    return cpus[cpuNumber].readyQueueLength + (cpus[cpuNumber].runningProcess != nullptr ? 1 : 0);
+}
+
+// A function to select the CPU whose ready queue receives a process becoming ready
+// New processes go to the least loaded CPU. Other processes stay on their last CPU
+// unless another CPU is less loaded by at least two processes, in which case they migrate
+int selectCpu(Process *process, bool isNewProcess)
+{
+    int leastLoadedCpu = 0;
+    for (int i = 1; i < cpus.size(); i++)
+        if (getCpuLoad(i) < getCpuLoad(leastLoadedCpu))
+            leastLoadedCpu = i;
+    if (isNewProcess)
+        return leastLoadedCpu;
+    if (getCpuLoad(leastLoadedCpu) + 2 <= getCpuLoad(process->cpu))
+    {
+        cpus[leastLoadedCpu].migrations++;
+        return leastLoadedCpu;
+    }
+    return process->cpu;
+}
+
+// A function to assign a process to a CPU, handing its scheduling state over if it comes from another CPU
+// The scheduler is called through its concrete type, so the call is not virtual
+template <class SchedulerType>
+void assignProcessToCpu(Process *process, int cpuNumber)
+{
+    if (process->cpu != cpuNumber)
+        static_cast<SchedulerType *>(cpus[cpuNumber].scheduler)->SchedulerType::migrateProcess(process, cpus[process->cpu].scheduler);
+    process->cpu = cpuNumber;
+}
+
+// A function to add a ready process to the ready queue of the selected CPU
+// The scheduler is called through its concrete type, so the call is not virtual
+template <class SchedulerType>
+void addProcessToCpu(Process *process, int cpuNumber)
+{
+    assignProcessToCpu<SchedulerType>(process, cpuNumber);
+    static_cast<SchedulerType *>(cpus[cpuNumber].scheduler)->SchedulerType::addProcess(process);
+    cpus[cpuNumber].readyQueueLength++;
+    if (counters != nullptr)
+        counters->readyQueueHighWater = max(counters->readyQueueHighWater, (long long)cpus[cpuNumber].readyQueueLength);
+}
+
+// A function to get the next process for an idle CPU
+// If the ready queue of the CPU is empty, the process is stolen from the CPU with the longest ready queue
+template <class SchedulerType>
+Process *getNextProcessForCpu(int cpuNumber)
+{
+    int sourceCpu = cpuNumber;
+    if (cpus[cpuNumber].readyQueueLength == 0)
+    {
+        for (int i = 0; i < cpus.size(); i++)
+            if (cpus[i].readyQueueLength > cpus[sourceCpu].readyQueueLength)
+                sourceCpu = i;
+        if (cpus[sourceCpu].readyQueueLength == 0)
+            return nullptr;
+    }
+    Process *process = static_cast<SchedulerType *>(cpus[sourceCpu].scheduler)->SchedulerType::getNextProcess();
+    if (process == nullptr)
+        return nullptr;
+    cpus[sourceCpu].readyQueueLength--;
+    if (sourceCpu != cpuNumber)
+        cpus[cpuNumber].migrations++;
+    assignProcessToCpu<SchedulerType>(process, cpuNumber);
+    return process;
+}
+
+// A function to generate the random number at a given position of the random values
+int randomNumberAt(int index, int burst)
+{
+    return 1 + (randomValues[index % MAX_RANDOM_VALUES_LENGTH] % burst);
+}
+
+// A function to generate random numbers using the random values and the random index offset
+int randomNumberGenerator(int burst)
+{
+    int value = randomNumberAt(randomIndexOffset, burst);
+    randomIndexOffset = (randomIndexOffset + 1) % MAX_RANDOM_VALUES_LENGTH;
+    return value;
+}
+
+// A function to display the event queue
+void displayEventQueue()
+{
+    vector<Event *> events = getOrderedEvents();
+    if (events.empty())
+        emitTraceRecord(TRACE_EVENT_QUEUE_EMPTY);
+    else
+        for (int i = 0; i < events.size(); i++)
+            emitTraceRecord(TRACE_EVENT_QUEUE_ENTRY, 0, events[i]->oldState, events[i]->newState,
+                            events[i]->timeStamp, events[i]->process->processNumber, events[i]->process->dynamicPriority);
+}
+
+// A function to add an event to the sorted eventQueue vector
+void addEventToVector(Event *event, bool beforeEqualTimeStamps)
+{
+    // If the eventQueue is empty, add the event to the eventQueue
+    int position = eventQueue.size();
+    if (eventQueueHead == eventQueue.size())
+        eventQueue.push_back(event);
+    else
+    {
+        bool added = false;
+        // Find the correct position to insert the event based on the timestamp
+        for (int i = eventQueueHead; i < eventQueue.size(); i++)
+        {
+            if (eventQueue[i]->timeStamp > event->timeStamp || (beforeEqualTimeStamps && eventQueue[i]->timeStamp == event->timeStamp))
+            {
+                eventQueue.insert(eventQueue.begin() + i, event);
+                added = true;
+                position = i;
+                break;
+            }
+        }
+        // Add the event to the end of the eventQueue if the timestamp is greater than all the events in the eventQueue
+        if (!added)
+            eventQueue.push_back(event);
+    }
+
+    // Count the entries compared to find the position of the event
+    if (counters != nullptr)
+    {
+        counters->eventsAdded++;
+        counters->eventInsertProbes += min(position - eventQueueHead + 1, (int)eventQueue.size() - eventQueueHead - 1);
+        counters->eventsAppended += position == eventQueue.size() - 1;
+        counters->maxEventQueueLength = max(counters->maxEventQueueLength, (long long)eventQueue.size() - eventQueueHead);
+    }
+}
+
+// A function to add an event to the eventQueue in order of the timestamp
+// If beforeEqualTimeStamps is set, the event is inserted before the events with the same timestamp
+void addEvent(Event *event, bool showEventQueue = false, bool beforeEqualTimeStamps = false)
+{
+    if (showEventQueue)
+    {
+        emitTraceRecord(TRACE_ADD_EVENT, 0, event->oldState, event->newState,
+                        event->timeStamp, event->process->processNumber, event->process->dynamicPriority);
+        displayEventQueue();
+        emitTraceRecord(TRACE_EVENT_QUEUE_ARROW);
+    }
+
+    // Add the event to the calendar queue if it is selected
+    if (calendarQueue != nullptr)
+    {
+        int probes = calendarQueue->add(event, beforeEqualTimeStamps);
+        if (counters != nullptr)
+        {
+            counters->eventsAdded++;
+            counters->eventInsertProbes += probes;
+            counters->maxEventQueueLength = max(counters->maxEventQueueLength, (long long)calendarQueue->size);
+        }
+    }
+    else
+        addEventToVector(event, beforeEqualTimeStamps);
+
+    if (showEventQueue)
+    {
+        displayEventQueue();
+        showEndLine();
+    }
+}
+
+// An Arrival class to store a line of the input file
+class Arrival
+{
+public:
+    int arrivalTime; // The arrival time of the process
+    int cpuTime;     // The total CPU time of the process
+    int cpuBurst;    // The defined CPU burst of the process
+    int ioBurst;     // The defined I/O burst of the process
+    int tickets;     // The tickets of the process from the optional column, 0 if not given
+    int deadline;    // The relative deadline of the process from the optional column, 0 if not given
+    int period;      // The period of the process from the optional column, 0 if not given
+};
+
+// A function to parse a line of the input file
+Arrival parseArrival(char *line)
+{
+    Arrival arrival;
+    arrival.arrivalTime = atoi(strtok(line, " "));
+    arrival.cpuTime = atoi(strtok(NULL, " "));
+    arrival.cpuBurst = atoi(strtok(NULL, " "));
+    arrival.ioBurst = atoi(strtok(NULL, " "));
+    // Read the optional tickets column
+    char *tickets = strtok(NULL, " ");
+    arrival.tickets = tickets != NULL ? max(atoi(tickets), 0) : 0;
+    // Read the optional relative deadline and period columns
+    char *deadline = strtok(NULL, " ");
+    arrival.deadline = deadline != NULL ? max(atoi(deadline), 0) : 0;
+    char *period = strtok(NULL, " ");
+    arrival.period = period != NULL && arrival.deadline > 0 ? max(atoi(period), 0) : 0;
+    return arrival;
+}
+
+// A function to create a process from an arrival of the input file
+Process *createProcess(const Arrival &arrival, int processNumber, int staticPriority)
+{
+    Process *process = new Process();
+    process->processNumber = processNumber;
+    process->arrivalTime = arrival.arrivalTime;
+    process->cpuTime = arrival.cpuTime;
+    process->remainingCpuTime = process->cpuTime;
+    process->cpuBurst = arrival.cpuBurst;
+    process->currentCpuBurst = 0;
+    process->ioBurst = arrival.ioBurst;
+    processTickets[processNumber] = arrival.tickets;
+    ProcessDeadline deadline;
+    if (arrival.deadline > 0)
+    {
+        deadline.relativeDeadline = arrival.deadline;
+        deadline.period = arrival.period;
+        deadline.absoluteDeadline = arrival.arrivalTime + arrival.deadline;
+        hasDeadlines = true;
+    }
+    processDeadlines[processNumber] = deadline;
+    process->staticPriority = staticPriority;
+    process->dynamicPriority = process->staticPriority - 1;
+    process->stateTimeStamp = process->arrivalTime;
+    return process;
+}
+
+// A function to create the arrival event of a process
+Event *createArrivalEvent(Process *process)
+{
+    Event *event = new Event();
+    event->timeStamp = process->arrivalTime;
+    event->process = process;
+    event->oldState = CREATED;
+    event->newState = READY;
+    event->transition = TO_READY;
+    return event;
+}
+
+// A function to read the input file and populate the eventQueue
+void readInputFile(FILE *inputFile, int maxprios = 4, bool showEventQueue = false)
+{
+    int processNumber = 0;
+    // Read the input file and populate the eventQueue
+    static char line[1024];
+    while (fgets(line, 1024, inputFile) != NULL)
+    {
+        // Create a process and populate the process information
+        Process *process = createProcess(parseArrival(line), processNumber++, randomNumberGenerator(maxprios));
+        processes.push_back(process);
+
+        // Create an event for the process and push it to the eventQueue
+        addEvent(createArrivalEvent(process), showEventQueue);
+    }
+}
+
+// Variables to store the state of the streaming mode, where arrivals are read lazily from the input file
+bool streamArrivals = false;           // Whether the arrivals are streamed from the input file
+FILE *streamInputFile = nullptr;       // The input file the arrivals are streamed from
+int streamMaxprios = 4;                // The maximum number of priorities used to draw static priorities
+int streamNextProcessNumber = 0;       // The process number of the next process to be read
+int streamNextProcessToReport = 0;     // The process number of the next process to be summarized
+map<int, Process *> finishedProcesses; // The finished processes waiting for earlier processes to be summarized
+
+// A function to start streaming the arrivals from the input file
+// The input file is counted first so that the static priorities and the random offset are drawn
+// exactly as if all processes were read upfront, which keeps the simulation identical
+void startStreamingInputFile(FILE *inputFile, int maxprios)
+{
+    static char line[1024];
+    int numProcesses = 0;
+    while (fgets(line, 1024, inputFile) != NULL)
+        numProcesses++;
+    rewind(inputFile);
+
+    streamArrivals = true;
+    streamInputFile = inputFile;
+    streamMaxprios = maxprios;
+    randomIndexOffset = numProcesses % MAX_RANDOM_VALUES_LENGTH;
+}
+
+// An ArrivalQueue class to pass arrivals from the producer thread to the simulation in live mode
+// It is a single-producer single-consumer ring buffer. The producer only writes the tail and the consumer
+// only writes the head, so no locks are needed; the release stores publish the slots to the other thread.
+// A side that has to wait yields a bounded number of times and then blocks on a condition variable, so an idle
+// producer, for example a named pipe with no writer activity for hours, does not keep the consumer spinning
+class ArrivalQueue
+{
+public:
+    static const int CAPACITY = 4096;           // The number of slots, a power of two
+    static const int SPIN_LIMIT = 1024;         // The number of times a side yields before it blocks
+    Arrival slots[CAPACITY];                    // The arrivals in the ring buffer
+    alignas(64) atomic<size_t> head{0};         // The position of the next arrival to pop, written by the consumer
+    alignas(64) atomic<size_t> tail{0};         // The position of the next arrival to push, written by the producer
+    atomic<bool> closed{false};                 // Whether the producer has pushed its last arrival
+    atomic<bool> producerWaiting{false};        // Whether the producer is blocked on a full ring buffer
+    atomic<bool> consumerWaiting{false};        // Whether the consumer is blocked on an empty ring buffer
+    mutex waitMutex;                            // The mutex of the condition variables
+    condition_variable notFull, notEmpty;       // The signals that a slot was freed and that an arrival was pushed
+
+    // Wait until a condition holds, yielding a bounded number of times before blocking
+    // The waiting flag is set before the condition is checked again under the mutex, and the other side checks the
+    // flag after publishing, with a full fence on both sides, so either the condition or the flag is seen
+    template <typename Condition>
+    void waitUntil(atomic<bool> &waiting, condition_variable &signal, Condition condition)
+    {
+        for (int spins = 0; spins < SPIN_LIMIT; spins++)
+        {
+            if (condition())
+                return;
+            this_thread::yield();
+        }
+        unique_lock<mutex> lock(waitMutex);
+        waiting.store(true, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        signal.wait(lock, condition);
+        waiting.store(false, memory_order_relaxed);
+    }
+
+    // Wake the other side if it is blocked, after publishing a change of the ring buffer
+    void wake(atomic<bool> &waiting, condition_variable &signal)
+    {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (waiting.load(memory_order_relaxed))
+        {
+            lock_guard<mutex> lock(waitMutex);
+            signal.notify_one();
+        }
+    }
+
+    // Push an arrival, waiting while the ring buffer is full
+    void push(const Arrival &arrival)
+    {
+        size_t position = tail.load(memory_order_relaxed);
+        waitUntil(producerWaiting, notFull, [&]()
+                  { return position - head.load(memory_order_acquire) != CAPACITY; });
+        slots[position & (CAPACITY - 1)] = arrival;
+        tail.store(position + 1, memory_order_release);
+        wake(consumerWaiting, notEmpty);
+    }
+
+    // Mark the last arrival as pushed
+    void close()
+    {
+        closed.store(true, memory_order_release);
+        wake(consumerWaiting, notEmpty);
+    }
+
+    // Pop an arrival, waiting while the ring buffer is empty. Returns false once the producer is done
+    bool pop(Arrival *arrival)
+    {
+        size_t position = head.load(memory_order_relaxed);
+        waitUntil(consumerWaiting, notEmpty, [&]()
+                  { return position != tail.load(memory_order_acquire) || closed.load(memory_order_acquire); });
+        // The last arrivals are pushed before closing, so the tail is checked again after seeing it closed
+        if (position == tail.load(memory_order_acquire))
+            return false;
+        *arrival = slots[position & (CAPACITY - 1)];
+        head.store(position + 1, memory_order_release);
+        wake(producerWaiting, notFull);
+        return true;
+    }
+};
+
+// The ingestion queue of live mode. If it is not set, streamed arrivals are read directly from the input file
+ArrivalQueue *liveArrivals = nullptr;
+
+// A function run by the producer thread of live mode, which reads the arrivals from the input file as they are
+// written, for example by a trace replayer writing to a named pipe, and pushes them to the ingestion queue
+void produceLiveArrivals(FILE *inputFile)
+{
+    static char line[1024];
+    while (fgets(line, 1024, inputFile) != NULL)
+        liveArrivals->push(parseArrival(line));
+    liveArrivals->close();
+}
+
+// A function to start live mode, where a producer thread feeds the arrivals through the ingestion queue
+// The finished processes are summarized and released as in streaming mode
+thread *liveProducer = nullptr;
+void startLiveArrivals(FILE *inputFile, int maxprios)
+{
+    streamArrivals = true;
+    streamMaxprios = maxprios;
+    liveArrivals = new ArrivalQueue();
+    liveProducer = new thread(produceLiveArrivals, inputFile);
+}
+
+// A function to read the next process from the streamed input file and add its arrival event
+// The input is sorted by arrival time, so only one pending arrival is kept in the eventQueue.
+// It is inserted before the events with the same timestamp, matching the order of an upfront read
+void readNextArrival(bool showEventQueue)
+{
+    static char line[1024];
+    Arrival arrival;
+    int processNumber = streamNextProcessNumber;
+    int staticPriority;
+    if (liveArrivals != nullptr)
+    {
+        // A live arrival is taken from the ingestion queue, waiting for the producer if needed
+        // The number of processes is not known upfront, so the static priority is drawn as the process arrives
+        if (!liveArrivals->pop(&arrival))
+            return;
+        staticPriority = randomNumberGenerator(streamMaxprios);
+    }
+    else
+    {
+        if (fgets(line, 1024, streamInputFile) == NULL)
+            return;
+        arrival = parseArrival(line);
+        staticPriority = randomNumberAt(processNumber, streamMaxprios);
+    }
+    streamNextProcessNumber++;
+    Process *process = createProcess(arrival, processNumber, staticPriority);
+    addEvent(createArrivalEvent(process), showEventQueue, true);
+}
+
+// A function to test if the eventQueue has no events left to pop
+bool isEventQueueEmpty()
+{
+    if (calendarQueue != nullptr)
+        return calendarQueue->size == 0;
+    return eventQueueHead == eventQueue.size();
+}
+
+// A function to return the head of the eventQueue
+// The events of a time stamp are popped in FIFO order without moving the rest of the queue,
+// and are removed together once all of them are processed
+Event *getEvent()
+{
+    if (calendarQueue != nullptr)
+        return calendarQueue->pop();
+    if (isEventQueueEmpty() || eventQueue[eventQueueHead]->timeStamp != lastEventTimeStamp)
+    {
+        eventQueue.erase(eventQueue.begin(), eventQueue.begin() + eventQueueHead);
+        eventQueueHead = 0;
+    }
+    if (isEventQueueEmpty())
+        return NULL;
+    Event *event = eventQueue[eventQueueHead++];
+    lastEventTimeStamp = event->timeStamp;
+    return event;
+}
+
+// A function to get the timestamp of the next event in the eventQueue
+int getNextEventTimeStamp()
+{
+    if (isEventQueueEmpty())
+        return -1;
+    if (calendarQueue != nullptr)
+        return calendarQueue->peek()->timeStamp;
+    return eventQueue[eventQueueHead]->timeStamp;
+}
+
+// A function to print the verbose output during state transitions
+// The burst, remaining time and priority are shown depending on the message
+void displayStateTransition(int currentTime, int processNumber, int timeInPreviousState, State oldState, State newState,
+                            TraceMessage message = NO_MESSAGE, int burst = 0, int remainingTime = 0, int priority = 0)
+{
+    emitTraceRecord(TRACE_TRANSITION, message, oldState, newState,
+                    currentTime, processNumber, timeInPreviousState, burst, remainingTime, priority);
+}
+
+// A LatencyHistogram class to store a distribution of durations in bounded memory
+// Durations are counted in log-bucketed counters as in HDR histograms: values below 2^SUB_BUCKET_BITS have a
+// bucket each, and every larger power of two is split into 2^SUB_BUCKET_BITS buckets, so a percentile is
+// reported within 1/2^SUB_BUCKET_BITS of the recorded value. Only the buckets that were hit are stored, so
+// a histogram with few values stays small whatever its precision
+template <int SUB_BUCKET_BITS>
+class LatencyHistogram
+{
+public:
+    vector<pair<int, uint32_t>> counts; // The buckets hit in increasing order, with the number of values recorded in each
+    long long totalCount = 0;           // The number of values recorded
+    int maxValue = 0;                   // The largest value recorded
+
+    // Return the bucket of a value
+    static int getBucket(int value)
+    {
+        if (value < (1 << SUB_BUCKET_BITS))
+            return value;
+        int magnitude = 31 - __builtin_clz(value);
+        int shift = magnitude - SUB_BUCKET_BITS;
+        return ((shift + 1) << SUB_BUCKET_BITS) + ((value >> shift) & ((1 << SUB_BUCKET_BITS) - 1));
+    }
+
+    // Return the largest value of a bucket
+    static int getBucketHighestValue(int bucket)
+    {
+        if (bucket < (1 << SUB_BUCKET_BITS))
+            return bucket;
+        int shift = (bucket >> SUB_BUCKET_BITS) - 1;
+        long long lowestValue = (long long)((1 << SUB_BUCKET_BITS) + (bucket & ((1 << SUB_BUCKET_BITS) - 1))) << shift;
+        return lowestValue + (1LL << shift) - 1;
+    }
+
+    // Record a duration
+    void record(int value)
+    {
+        value = max(value, 0);
+        int bucket = getBucket(value);
+        vector<pair<int, uint32_t>>::iterator it = lower_bound(counts.begin(), counts.end(), make_pair(bucket, 0u));
+        if (it == counts.end() || it->first != bucket)
+            it = counts.insert(it, make_pair(bucket, 0u));
+        it->second++;
+        totalCount++;
+        maxValue = max(maxValue, value);
+    }
+
+    // Return the value at a percentile, capped by the largest value recorded
+    int getPercentile(double percentile)
+    {
+        long long rank = max(1LL, (long long)ceil(percentile / 100.0 * totalCount));
+        long long count = 0;
+        for (int i = 0; i < counts.size(); i++)
+        {
+            count += counts[i].second;
+            if (count >= rank)
+                return min(getBucketHighestValue(counts[i].first), maxValue);
+        }
+        return maxValue;
+    }
+
+    // Write the histogram to a checkpoint file
+    void writeCheckpoint(FILE *file)
+    {
+        writeCheckpointLongValue(file, totalCount);
+        writeCheckpointValue(file, maxValue);
+        writeCheckpointValue(file, counts.size());
+        fwrite(counts.data(), sizeof(pair<int, uint32_t>), counts.size(), file);
+    }
+
+    // Read the histogram from a checkpoint file
+    void readCheckpoint(FILE *file)
+    {
+        totalCount = readCheckpointLongValue(file);
+        maxValue = readCheckpointValue(file);
+        counts.resize(readCheckpointValue(file));
+        if (!counts.empty())
+            readCheckpointBlock(file, counts.data(), sizeof(pair<int, uint32_t>) * counts.size());
+    }
+};
+
+// The global distributions see every dispatch and I/O burst and are reported to within 1/128, while the
+// distributions of a process, of which there may be millions, are reported to within 1/32
+typedef LatencyHistogram<7> GlobalLatencyHistogram;
+typedef LatencyHistogram<5> ProcessLatencyHistogram;
+
+// A ProcessLatencies class to store the latency distributions of a process
+class ProcessLatencies
+{
+public:
+    ProcessLatencyHistogram waitTimes; // The time spent in the ready queue before each dispatch
+    ProcessLatencyHistogram ioBursts;  // The duration of each I/O burst
+    bool dispatched = false;           // Whether the process has run, to record its response time once
+};
+
+// Variables to store the latency distributions for the extended summary, which are recorded only with -x
+bool recordLatencies = false;                      // Whether latencies are recorded and shown in the extended summary
+GlobalLatencyHistogram waitTimes;                  // The ready queue wait per dispatch of all processes
+GlobalLatencyHistogram responseTimes;              // The time from arrival to the first dispatch of all processes
+GlobalLatencyHistogram ioBursts;                   // The duration of the I/O bursts of all processes
+ProcessTable<ProcessLatencies *> processLatencies; // The latency distributions of each process by process number
+
+// A function to return the latency distributions of a process, allocating them on first use
+ProcessLatencies *getProcessLatencies(Process *process)
+{
+    if (processLatencies[process->processNumber] == nullptr)
+        processLatencies[process->processNumber] = new ProcessLatencies();
+    return processLatencies[process->processNumber];
+}
+
+// A function to record the ready queue wait of a process when it is dispatched, and its response time on the first dispatch
+void recordDispatchLatency(Process *process, int currentTime, int waitTime)
+{
+    ProcessLatencies *latencies = getProcessLatencies(process);
+    latencies->waitTimes.record(waitTime);
+    waitTimes.record(waitTime);
+    if (!latencies->dispatched)
+    {
+        latencies->dispatched = true;
+        responseTimes.record(currentTime - process->arrivalTime);
+    }
+}
+
+// A function to record the duration of an I/O burst of a process
+void recordIoLatency(Process *process, int ioBurst)
+{
+    getProcessLatencies(process)->ioBursts.record(ioBurst);
+    ioBursts.record(ioBurst);
+}
+
+// A function to display the percentiles of a latency distribution
+template <int SUB_BUCKET_BITS>
+void displayLatencyPercentiles(const char *name, LatencyHistogram<SUB_BUCKET_BITS> &histogram)
+{
+    cout << name << ": n=" << histogram.totalCount
+         << " p50=" << histogram.getPercentile(50)
+         << " p90=" << histogram.getPercentile(90)
+         << " p99=" << histogram.getPercentile(99)
+         << " p99.9=" << histogram.getPercentile(99.9)
+         << " max=" << histogram.maxValue;
+}
+
+// Variables to store summary statistics
+int simulationFinishTime = 0, totalProcesses = 0;
+long long totalTurnaroundTime = 0, totalWaitTime = 0; // Kept in 64 bits so that long live runs do not overflow
+ProcessDeadline totalDeadline;                        // The deadline statistics of all the jobs
 
-// A function to generate random numbers using the random values and the random index offset
-int randomNumberGenerator(int burst)
+// A function to print the deadline statistics of a set of jobs
+void displayDeadlineStatistics(const char *name, ProcessDeadline &deadline)
 {
-    int value = 1 + (randomValues[randomIndexOffset] % burst);
-    randomIndexOffset = (randomIndexOffset + 1) % MAX_RANDOM_VALUES_LENGTH;
-    return value;
+    cout << name << ": jobs=" << deadline.jobs << " missed=" << deadline.misses;
+    if (deadline.jobs > 0)
+        cout << " lateness avg=" << fixed << setprecision(2) << deadline.totalLateness / (double)deadline.jobs
+             << " max=" << deadline.maxLateness;
 }
 
-// A function to read the random values from the random file and populate the randomValues array
-void readRandomFile(FILE *randomFile)
+// A function to display the information of a process and add it to the summary statistics
+void displayProcess(Process *process)
 {
-    // Read the random values from the random file. The first line is the number of random values and the rest are the random values
-    static char line[1024];
-    if (fgets(line, 1024, randomFile) != NULL)
+    cout << setw(4) << setfill('0') << process->processNumber << ": "
+         << setw(4) << setfill(' ') << process->arrivalTime << " "
+         << setw(4) << process->cpuTime << " "
+         << setw(4) << process->cpuBurst << " "
+         << setw(4) << process->ioBurst << " "
+         << setw(1) << process->staticPriority << " | "
+         << setw(5) << process->finishTime << " "
+         << setw(5) << process->turnaroundTime << " "
+         << setw(5) << process->ioTime << " "
+         << setw(5) << process->cpuWaitTime << endl;
+
+    // Print the latency distributions of the process in the extended summary, and release them
+    if (recordLatencies)
     {
-        MAX_RANDOM_VALUES_LENGTH = atoi(line);
-        randomValues = (int *)calloc(MAX_RANDOM_VALUES_LENGTH, sizeof(int));
-        for (int i = 0; i < MAX_RANDOM_VALUES_LENGTH; i++)
-        {
-            if (fgets(line, 1024, randomFile) != NULL)
-                randomValues[i] = atoi(line);
-        }
+        ProcessLatencies *latencies = getProcessLatencies(process);
+        displayLatencyPercentiles("      WAIT", latencies->waitTimes);
+        displayLatencyPercentiles(" IO", latencies->ioBursts);
+        cout << endl;
+        delete latencies;
+        processLatencies[process->processNumber] = nullptr;
+    }
+
+    // Print the deadline statistics of a process with a deadline, and add them to the totals
+    if (hasDeadlines && processDeadlines[process->processNumber].relativeDeadline > 0)
+    {
+        ProcessDeadline &deadline = processDeadlines[process->processNumber];
+        displayDeadlineStatistics("      DEADLINE", deadline);
+        cout << endl;
+        totalDeadline.jobs += deadline.jobs;
+        totalDeadline.misses += deadline.misses;
+        totalDeadline.maxLateness = max(totalDeadline.maxLateness, deadline.maxLateness);
+        totalDeadline.totalLateness += deadline.totalLateness;
     }
+
+    // Update the simulation finish time if the current process finish time is greater
+    simulationFinishTime = (process->finishTime > simulationFinishTime)
+                               ? process->finishTime
+                               : simulationFinishTime;
+
+    // Update the scheduler statistics from the current process
+    scheduler->cpuTime += process->cpuTime;
+    totalTurnaroundTime += process->turnaroundTime;
+    totalWaitTime += process->cpuWaitTime;
+    totalProcesses++;
 }
 
-// A vector to store the processes
-vector<Process *> processes;
+// Variables to store the rolling statistics published in live mode
+int rollingPeriod = 0;   // The simulated time between rolling statistics, 0 if they are not published
+int nextRollingTime = 0; // The simulated time at which the next rolling statistics are published
 
-// A function to map the state enum to a string representation
-string stateToString(State state)
+// A function to publish the rolling statistics of live mode, as of the current simulated time
+// The averages cover the processes summarized so far, and the utilizations the time simulated so far
+void publishRollingStatistics(int currentTime)
 {
-    switch (state)
-    {
-    case CREATED:
-        return "CREATED";
-    case READY:
-        return "READY";
-    case RUNNING:
-        return "RUNNING";
-    case BLOCKED:
-        return "BLOCKED";
-    }
-    return "";
+    int busyTime = 0;
+    for (int i = 0; i < cpus.size(); i++)
+        busyTime += cpus[i].busyTime;
+    int ioTime = scheduler->ioTime + (scheduler->blockedProcesses > 0 ? currentTime - scheduler->ioBusyStartTime : 0);
+    cout << "LIVE: " << currentTime << " " << totalProcesses << " "
+         << fixed << setprecision(2) << 100.0 * (busyTime / ((double)currentTime * cpus.size())) << " "
+         << fixed << setprecision(2) << 100.0 * (ioTime / (double)currentTime) << " "
+         << fixed << setprecision(2) << (totalProcesses > 0 ? totalTurnaroundTime / (double)totalProcesses : 0.0) << " "
+         << fixed << setprecision(2) << (totalProcesses > 0 ? totalWaitTime / (double)totalProcesses : 0.0) << endl;
+    nextRollingTime = (currentTime / rollingPeriod + 1) * rollingPeriod;
 }
 
-// A function to display the event queue
-void displayEventQueue()
+// A function to summarize a finished process in streaming mode and release it
+// The processes are summarized in the order of the process number, so a finished process
+// is held until all earlier processes have finished. The memory is therefore bounded by the
+// processes since the oldest unfinished one, not by the live processes: a single long process
+// keeps every later process resident until it finishes
+void releaseFinishedProcess(Process *process)
 {
-    if (eventQueue.empty())
-        cout << "()";
-    else
-        for (int i = 0; i < eventQueue.size(); i++)
-        {
-            {
-                cout << "(t=" << eventQueue[i]->timeStamp << " "
-                     << "pid=" << eventQueue[i]->process->processNumber << " "
-                     << "prio=" << eventQueue[i]->process->dynamicPriority << " "
-                     << stateToString(eventQueue[i]->oldState) << "->"
-                     << stateToString(eventQueue[i]->newState) << ") | ";
-            }
-        }
+    finishedProcesses[process->processNumber] = process;
+    while (!finishedProcesses.empty() && finishedProcesses.begin()->first == streamNextProcessToReport)
+    {
+        Process *finishedProcess = finishedProcesses.begin()->second;
+        finishedProcesses.erase(finishedProcesses.begin());
+        displayProcess(finishedProcess);
+        delete finishedProcess;
+        streamNextProcessToReport++;
+    }
+
+    // Drop the values kept outside the Process class for the summarized processes
+    processTickets.releaseBefore(streamNextProcessToReport);
+    processDeadlines.releaseBefore(streamNextProcessToReport);
+    processLatencies.releaseBefore(streamNextProcessToReport);
+    if (calendarQueue != nullptr)
+        calendarQueue->pendingEvents.releaseBefore(streamNextProcessToReport);
+    for (int i = 0; i < cpus.size(); i++)
+        cpus[i].scheduler->releaseProcessesBefore(streamNextProcessToReport);
 }
 
-// A function to add an event to the eventQueue in order of the timestamp
-void addEvent(Event *event, bool showEventQueue = false)
+// Variables to store the checkpoint state
+const int CHECKPOINT_MAGIC = 0x53434b50; // The magic number identifying a checkpoint file
+string checkpointSchedulerSpec = "F";    // The scheduler specification stored in the checkpoint
+int checkpointEventCount = -1;           // The number of processed events at which the checkpoint is written
+int checkpointTime = -1;                 // The time at which the checkpoint is written
+FILE *checkpointFile = nullptr;          // The checkpoint file to write
+int eventsProcessed = 0;                 // The number of events processed so far
+bool callScheduler = false;              // Whether the scheduler is to be called after the current events
+
+// A function to write the complete simulation state to the checkpoint file
+void writeCheckpoint(FILE *file)
 {
-    if (showEventQueue)
+    // Write the configuration of the simulation
+    writeCheckpointValue(file, CHECKPOINT_MAGIC);
+    writeCheckpointValue(file, checkpointSchedulerSpec.size());
+    fwrite(checkpointSchedulerSpec.data(), 1, checkpointSchedulerSpec.size(), file);
+    writeCheckpointValue(file, cpus.size());
+    writeCheckpointValue(file, recordLatencies);
+    writeCheckpointValue(file, dispatchCost);
+    writeCheckpointValue(file, switchCost);
+
+    // Write the simulation progress and the random offset
+    writeCheckpointValue(file, randomIndexOffset);
+    writeCheckpointValue(file, eventsProcessed);
+    writeCheckpointValue(file, callScheduler);
+
+    // Write the processes, their tickets and their deadlines
+    writeCheckpointValue(file, processes.size());
+    for (int i = 0; i < processes.size(); i++)
     {
-        cout << "AddEvent(t=" << event->timeStamp
-             << " pid=" << event->process->processNumber
-             << " prio=" << event->process->dynamicPriority
-             << " trans=" << stateToString(event->oldState) << "->" << stateToString(event->newState) << "): ";
-        displayEventQueue();
-        cout << " => ";
+        fwrite(processes[i], sizeof(Process), 1, file);
+        writeCheckpointValue(file, processTickets[i]);
+        fwrite(&processDeadlines[i], sizeof(ProcessDeadline), 1, file);
     }
 
-    // If the eventQueue is empty, add the event to the eventQueue
-    if (eventQueue.empty())
-        eventQueue.push_back(event);
-    else
+    // Write the event queue
+    vector<Event *> events = getOrderedEvents();
+    writeCheckpointValue(file, events.size());
+    for (int i = 0; i < events.size(); i++)
     {
-        bool added = false;
-        // Find the correct position to insert the event based on the timestamp
-        for (int i = 0; i < eventQueue.size(); i++)
+        writeCheckpointValue(file, events[i]->timeStamp);
+        writeCheckpointValue(file, events[i]->process->processNumber);
+        writeCheckpointValue(file, events[i]->oldState);
+        writeCheckpointValue(file, events[i]->newState);
+        writeCheckpointValue(file, events[i]->transition);
+    }
+
+    // Write the CPUs and their ready queues
+    for (int i = 0; i < cpus.size(); i++)
+    {
+        writeCheckpointValue(file, cpus[i].runningProcess != nullptr ? cpus[i].runningProcess->processNumber : -1);
+        writeCheckpointValue(file, cpus[i].readyQueueLength);
+        writeCheckpointValue(file, cpus[i].busyTime);
+        writeCheckpointValue(file, cpus[i].migrations);
+        writeCheckpointValue(file, cpus[i].lastProcessNumber);
+        writeCheckpointValue(file, cpus[i].dispatchEndTime);
+        writeCheckpointValue(file, cpus[i].overheadTime);
+        writeCheckpointValue(file, cpus[i].dispatches);
+        writeCheckpointValue(file, cpus[i].processSwitches);
+        cpus[i].scheduler->writeCheckpoint(file);
+    }
+
+    // Write the I/O accounting
+    writeCheckpointValue(file, scheduler->ioTime);
+    writeCheckpointValue(file, scheduler->blockedProcesses);
+    writeCheckpointValue(file, scheduler->ioBusyStartTime);
+
+    // Write the latency distributions if they are recorded
+    if (recordLatencies)
+    {
+        waitTimes.writeCheckpoint(file);
+        responseTimes.writeCheckpoint(file);
+        ioBursts.writeCheckpoint(file);
+        for (int i = 0; i < processes.size(); i++)
         {
-            if (eventQueue[i]->timeStamp > event->timeStamp)
-            {
-                eventQueue.insert(eventQueue.begin() + i, event);
-                added = true;
-                break;
-            }
+            ProcessLatencies *latencies = getProcessLatencies(processes[i]);
+            latencies->waitTimes.writeCheckpoint(file);
+            latencies->ioBursts.writeCheckpoint(file);
+            writeCheckpointValue(file, latencies->dispatched);
         }
-        // Add the event to the end of the eventQueue if the timestamp is greater than all the events in the eventQueue
-        if (!added)
-            eventQueue.push_back(event);
     }
+}
 
-    if (showEventQueue)
+// A function to read the configuration stored at the start of a checkpoint file
+// The scheduler specification, the number of CPUs and the dispatch costs of the checkpoint override the command line
+void readCheckpointConfiguration(FILE *file, int *numCpus)
+{
+    if (readCheckpointValue(file) != CHECKPOINT_MAGIC)
     {
-        displayEventQueue();
-        cout << endl;
+        cout << "Error: Not a checkpoint file." << endl;
+        exit(1);
+    }
+    checkpointSchedulerSpec = string(readCheckpointValue(file), ' ');
+    if (fread(&checkpointSchedulerSpec[0], 1, checkpointSchedulerSpec.size(), file) != checkpointSchedulerSpec.size())
+    {
+        cout << "Error: Checkpoint file is truncated." << endl;
+        exit(1);
     }
+    *numCpus = readCheckpointValue(file);
+    recordLatencies = readCheckpointValue(file);
+    dispatchCost = readCheckpointValue(file);
+    switchCost = readCheckpointValue(file);
 }
 
-// A function to read the input file and populate the eventQueue
-void readInputFile(FILE *inputFile, int maxprios = 4, bool showEventQueue = false)
+// A function to read the simulation state from the checkpoint file, after the CPUs are initialised
+void readCheckpoint(FILE *file)
 {
-    int processNumber = 0;
-    // Read the input file and populate the eventQueue
-    static char line[1024];
-    while (fgets(line, 1024, inputFile) != NULL)
+    // Read the simulation progress and the random offset
+    randomIndexOffset = readCheckpointValue(file);
+    eventsProcessed = readCheckpointValue(file);
+    callScheduler = readCheckpointValue(file);
+
+    // Read the processes, their tickets and their deadlines
+    int numProcesses = readCheckpointValue(file);
+    for (int i = 0; i < numProcesses; i++)
     {
-        // Create a process and populate the process information
         Process *process = new Process();
-        process->processNumber = processNumber++;
-        process->arrivalTime = atoi(strtok(line, " "));
-        process->cpuTime = atoi(strtok(NULL, " "));
-        process->remainingCpuTime = process->cpuTime;
-        process->cpuBurst = atoi(strtok(NULL, " "));
-        process->currentCpuBurst = 0;
-        process->ioBurst = atoi(strtok(NULL, " "));
-        process->staticPriority = randomNumberGenerator(maxprios);
-        process->dynamicPriority = process->staticPriority - 1;
-        process->stateTimeStamp = process->arrivalTime;
+        readCheckpointBlock(file, process, sizeof(Process));
         processes.push_back(process);
+        processTickets[i] = readCheckpointValue(file);
+        ProcessDeadline deadline;
+        readCheckpointBlock(file, &deadline, sizeof(ProcessDeadline));
+        processDeadlines[i] = deadline;
+        hasDeadlines = hasDeadlines || deadline.relativeDeadline > 0;
+    }
 
-        // Create an event for the process and push it to the eventQueue
+    // Read the event queue
+    int numEvents = readCheckpointValue(file);
+    for (int i = 0; i < numEvents; i++)
+    {
         Event *event = new Event();
-        event->timeStamp = process->arrivalTime;
-        event->process = process;
-        event->oldState = CREATED;
-        event->newState = READY;
-        event->transition = TO_READY;
-        addEvent(event, showEventQueue);
+        event->timeStamp = readCheckpointValue(file);
+        event->process = processes[readCheckpointValue(file)];
+        event->oldState = (State)readCheckpointValue(file);
+        event->newState = (State)readCheckpointValue(file);
+        event->transition = (Transition)readCheckpointValue(file);
+        if (calendarQueue != nullptr)
+            calendarQueue->add(event, false);
+        else
+            eventQueue.push_back(event);
     }
-}
 
-// A function to return the head of the eventQueue
-Event *getEvent()
-{
-    if (eventQueue.empty())
-        return NULL;
-    Event *event = eventQueue.front();
-    eventQueue.erase(eventQueue.begin());
-    return event;
-}
+    // Read the CPUs and their ready queues
+    for (int i = 0; i < cpus.size(); i++)
+    {
+        int runningProcessNumber = readCheckpointValue(file);
+        cpus[i].runningProcess = runningProcessNumber != -1 ? processes[runningProcessNumber] : nullptr;
+        cpus[i].readyQueueLength = readCheckpointValue(file);
+        cpus[i].busyTime = readCheckpointValue(file);
+        cpus[i].migrations = readCheckpointValue(file);
+        cpus[i].lastProcessNumber = readCheckpointValue(file);
+        cpus[i].dispatchEndTime = readCheckpointValue(file);
+        cpus[i].overheadTime = readCheckpointValue(file);
+        cpus[i].dispatches = readCheckpointValue(file);
+        cpus[i].processSwitches = readCheckpointValue(file);
+        cpus[i].scheduler->readCheckpoint(file);
+    }
 
-// A function to get the timestamp of the next event in the eventQueue
-int getNextEventTimeStamp()
-{
-    if (eventQueue.empty())
-        return -1;
-    return eventQueue.front()->timeStamp;
+    // Read the I/O accounting
+    scheduler->ioTime = readCheckpointValue(file);
+    scheduler->blockedProcesses = readCheckpointValue(file);
+    scheduler->ioBusyStartTime = readCheckpointValue(file);
+
+    // Read the latency distributions if they are recorded
+    if (recordLatencies)
+    {
+        waitTimes.readCheckpoint(file);
+        responseTimes.readCheckpoint(file);
+        ioBursts.readCheckpoint(file);
+        for (int i = 0; i < processes.size(); i++)
+        {
+            ProcessLatencies *latencies = getProcessLatencies(processes[i]);
+            latencies->waitTimes.readCheckpoint(file);
+            latencies->ioBursts.readCheckpoint(file);
+            latencies->dispatched = readCheckpointValue(file);
+        }
+    }
 }
 
-// A function to print the verbose output during state transitions
-void displayStateTransition(int currentTime, int processNumber, int timeInPreviousState, string oldState = "", string newState = "", string message = "")
+// A function to check if the checkpoint is due before the next event and write it
+// If the simulation ends before the checkpoint is due, the final state is written instead
+void checkCheckpoint()
 {
-    string transitionStr;
-    if (oldState == "" && newState == "")
-        transitionStr = "DONE";
-    else
-        transitionStr = oldState + " -> " + newState;
-    cout << "t=" << currentTime << " pid=" << processNumber << " tps=" << timeInPreviousState << ": "
-         << transitionStr << " " << message << endl;
+    if (checkpointFile == nullptr)
+        return;
+    if (eventsProcessed == checkpointEventCount || (checkpointTime >= 0 && getNextEventTimeStamp() >= checkpointTime) || isEventQueueEmpty())
+    {
+        writeCheckpoint(checkpointFile);
+        fclose(checkpointFile);
+        checkpointFile = nullptr;
+    }
 }
 
 // A function to simulate the execution of events
+// The simulation is instantiated per scheduler class, so the scheduler calls are not virtual, and per trace
+// configuration, so the fast path without any verbose output has no logging branches
+template <class SchedulerType, bool Trace>
 void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue, bool showPreemptionDecision)
 {
     Event *event;
 
-    // Initialize the variables to call the scheduler and the current running process
-    bool callScheduler = false;
-    Process *currentRunningProcess = nullptr;
-
-    while ((event = getEvent()) != NULL)
+    // The variable to call the scheduler is kept globally for checkpoints. The running processes are kept per CPU
+    while (true)
     {
+        // Write the checkpoint if it is due before the next event
+        checkCheckpoint();
+        if ((event = getEvent()) == NULL)
+            break;
+        eventsProcessed++;
+        if (counters != nullptr)
+            counters->eventsProcessed[event->transition]++;
         // Extract the process information from the event
         Process *process = event->process;
         // Set the current time to the event timestamp
         int currentTime = event->timeStamp;
+        // Publish the rolling statistics in live mode when the simulated time passes the next period
+        if (rollingPeriod > 0 && currentTime >= nextRollingTime)
+            publishRollingStatistics(currentTime);
         // Calculate the time spent in the previous state as the difference between the current time and the state timestamp
         int timeInPreviousState = currentTime - process->stateTimeStamp;
 
         // Obtain the transition, old state, and new state from the event
         Transition transition = event->transition;
         State oldState = event->oldState, newState = event->newState;
-        string oldStateStr = stateToString(oldState), newStateStr = stateToString(newState);
+        delete event;
         event = NULL;
 
+        // Read the next arrival when streaming, before the current arrival is processed
+        if (streamArrivals && oldState == CREATED)
+            readNextArrival(Trace && showEventQueue);
+        // Fetch the CPU the process is assigned to
+        Cpu *cpu = &cpus[process->cpu];
+        Process *currentRunningProcess = cpu->runningProcess;
+
         // Execute the event based on the transition
         switch (transition)
         {
-        case TO_READY: // Must come from CREATED, RUNNING or BLOCKED
+        case TO_READY: // Must come from CREATED, RUNNING, BLOCKED or WAITING
+            // A periodic process returning from I/O before its next period waits for the release instead
+            if (oldState == BLOCKED && hasDeadlines && waitsForRelease(process, currentTime))
+                newState = WAITING;
+
             // If there is a running process and it is the same as the process from the current event,
             // then set the currentRunningProcess to NULL as the process is transitioning to the ready state
             if (currentRunningProcess != nullptr && currentRunningProcess->processNumber == process->processNumber)
-                currentRunningProcess = nullptr;
+                cpu->runningProcess = nullptr;
 
             // Print the state transition if the showStateTransition flag is set
-            if (showStateTransition)
-                displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldStateStr, newStateStr);
+            if (Trace && showStateTransition)
+                displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldState, newState);
 
             if (oldState == BLOCKED) // If the process is returning from I/O
             {
                 // Reset the dynamic priority
                 process->dynamicPriority = process->staticPriority - 1;
-                // Add the I/O time to the process and add the timestamp to the ioTimeStamps vector
+                // Add the I/O time to the process
                 process->ioTime += timeInPreviousState;
-                scheduler->ioTimeStamps.push_back({process->stateTimeStamp, currentTime});
+                if (recordLatencies)
+                    recordIoLatency(process, timeInPreviousState);
+                // End the I/O busy period when the last process leaves I/O
+                if (--scheduler->blockedProcesses == 0)
+                    scheduler->ioTime += currentTime - scheduler->ioBusyStartTime;
+                // Create an event for the waiting process to become READY when its next job is released
+                if (newState == WAITING)
+                {
+                    process->stateTimeStamp = currentTime;
+                    Event *event = new Event();
+                    event->timeStamp = getReleaseTime(process);
+                    event->process = process;
+                    event->oldState = WAITING;
+                    event->newState = READY;
+                    event->transition = TO_READY;
+                    addEvent(event, Trace && showEventQueue);
+                    break;
+                }
             }
+            // Release the next job of a process with a deadline before it is queued by its deadline
+            if ((oldState == BLOCKED || oldState == WAITING) && hasDeadlines)
+                releaseJob(process, currentTime);
+
+            // Select the CPU whose ready queue receives the process
+            cpu = &cpus[selectCpu(process, oldState == CREATED)];
+            assignProcessToCpu<SchedulerType>(process, cpu->cpuNumber);
+            currentRunningProcess = cpu->runningProcess;
+            // A process still being dispatched cannot be preempted, as the switch to it is already under way
+            if (currentTime < cpu->dispatchEndTime)
+                currentRunningProcess = nullptr;
 
             // Check if the activated process can preempt the currently running process
-            // Applicable only for PreemptivePriority scheduler
-            if (scheduler->checkEventPreemption(process, currentRunningProcess, currentTime, showPreemptionDecision))
+            // Applicable only for the PREPRIO, CFS and EDF schedulers
+            if (counters != nullptr && currentRunningProcess != nullptr)
+                counters->preemptionChecks++;
+            if (static_cast<SchedulerType *>(cpu->scheduler)->SchedulerType::checkEventPreemption(process, currentRunningProcess, currentTime, Trace && showPreemptionDecision))
             {
+                if (counters != nullptr)
+                    counters->preemptions++;
                 int timeSpentInRunningState = currentTime - currentRunningProcess->stateTimeStamp;
                 // Remove the future event for the currently running process
-                for (int i = 0; i < eventQueue.size(); i++)
-                {
-                    if (eventQueue[i]->process->processNumber == currentRunningProcess->processNumber)
-                    {
-                        eventQueue.erase(eventQueue.begin() + i);
-                        break;
-                    }
-                }
+                cancelEvent(currentRunningProcess);
                 // Reset the current CPU burst and the remaining CPU time of the currently running process
                 // Undo the entire CPU burst and add the current time spent in the running state
                 currentRunningProcess->currentCpuBurst = currentRunningProcess->currentCpuBurst + currentRunningProcess->lastCpuExecutionTime - timeSpentInRunningState;
@@ -625,32 +2845,32 @@ void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue,
                 preemptEvent->oldState = RUNNING;
                 preemptEvent->newState = READY;
                 preemptEvent->transition = TO_PREEMPT;
-                addEvent(preemptEvent, showEventQueue);
+                addEvent(preemptEvent, Trace && showEventQueue);
             }
 
             // Set the state timestamp of the process as the current time
             process->stateTimeStamp = currentTime;
-            // Add the process to the ready queue, no event is generated
-            scheduler->addProcess(process);
+            // Add the process to the ready queue of the CPU, no event is generated
+            addProcessToCpu<SchedulerType>(process, cpu->cpuNumber);
             // Print the run queue if the showRunQueue flag is set
-            if (showRunQueue)
-                scheduler->showReadyQueue();
+            if (Trace && showRunQueue)
+                cpu->scheduler->showReadyQueue();
             // Call the scheduler to get the next process
             callScheduler = true;
             break;
 
         case TO_PREEMPT: // Must come from RUNNING
-            // Set the currentRunningProcess to NULL as the process is being preempted
-            currentRunningProcess = nullptr;
+            // Set the running process of the CPU to NULL as the process is being preempted
+            cpu->runningProcess = nullptr;
+            cpu->busyTime += timeInPreviousState;
+            static_cast<SchedulerType *>(cpu->scheduler)->SchedulerType::chargeCpuTime(process, timeInPreviousState);
             // Set the state timestamp of the process as the current time
             process->stateTimeStamp = currentTime;
 
             // Print the state transition if the showStateTransition flag is set
-            if (showStateTransition)
-            {
-                string message = "[cb=" + to_string(process->currentCpuBurst) + " rem=" + to_string(process->remainingCpuTime) + " prio=" + to_string(process->dynamicPriority) + "]";
-                displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldStateStr, newStateStr, message);
-            }
+            if (Trace && showStateTransition)
+                displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldState, newState,
+                                       CPU_BURST_MESSAGE, process->currentCpuBurst, process->remainingCpuTime, process->dynamicPriority);
 
             // Call the scheduler to get the next process
             callScheduler = true;
@@ -658,30 +2878,38 @@ void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue,
             {
                 // Decrement the dynamic priority of the process
                 process->dynamicPriority--;
-                // Add the process to the ready queue, no event is generated
-                scheduler->addProcess(process);
+                // Add the process to the ready queue of the selected CPU, no event is generated
+                cpu = &cpus[selectCpu(process, false)];
+                addProcessToCpu<SchedulerType>(process, cpu->cpuNumber);
                 // Print the ready queue if the showRunQueue flag is set
-                if (showRunQueue)
-                    scheduler->showReadyQueue();
+                if (Trace && showRunQueue)
+                    cpu->scheduler->showReadyQueue();
             }
             else // Process has no remaining CPU time, so it is done executing
             {
+                if (hasDeadlines)
+                    completeJob(process, currentTime);
                 // Set the current time as the finish time of the process
                 process->finishTime = currentTime;
                 // Calculate the turnaround time of the process
                 process->turnaroundTime = currentTime - process->arrivalTime;
                 // Print the state transition if the showStateTransition flag is set
-                if (showStateTransition)
-                    displayStateTransition(currentTime, process->processNumber, timeInPreviousState, "", "");
+                if (Trace && showStateTransition)
+                    displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldState, newState, DONE_MESSAGE);
+                // Summarize and release the process when streaming
+                if (streamArrivals)
+                    releaseFinishedProcess(process);
             }
             break;
 
         case TO_RUNNING: // Must come from READY
         {
-            // Set the currentRunningProcess to the process as it is now running
-            currentRunningProcess = process;
+            // Set the running process of the CPU to the process as it is now running
+            cpu->runningProcess = process;
             // Set the CPU wait time of the process as the time spent in the ready state
             process->cpuWaitTime += timeInPreviousState;
+            if (recordLatencies)
+                recordDispatchLatency(process, currentTime, timeInPreviousState);
             // Fetch the defined CPU burst and the remaining execution time of the process
             int cpuBurst = process->cpuBurst;
             int remainingExecutionTime = process->remainingCpuTime;
@@ -689,11 +2917,9 @@ void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue,
             process->currentCpuBurst = process->currentCpuBurst > 0 ? process->currentCpuBurst : randomNumberGenerator(cpuBurst);
 
             // Print the state transition if the showStateTransition flag is set
-            if (showStateTransition)
-            {
-                string message = "[cb=" + to_string(process->currentCpuBurst) + " rem=" + to_string(remainingExecutionTime) + " prio=" + to_string(process->dynamicPriority) + "]";
-                displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldStateStr, newStateStr, message);
-            }
+            if (Trace && showStateTransition)
+                displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldState, newState,
+                                       CPU_BURST_MESSAGE, process->currentCpuBurst, remainingExecutionTime, process->dynamicPriority);
 
             // Check if the process is yet to finish executing
             if (remainingExecutionTime > 0)
@@ -702,12 +2928,14 @@ void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue,
                 bool preempt = false;
                 // Fetch the current CPU burst for execution
                 int currentCpuBurstForExecution = process->currentCpuBurst;
-                // If the generated CPU burst is greater than the quantum, then the process needs to be preempted
-                if (currentCpuBurstForExecution > scheduler->quantum)
+                // If the generated CPU burst is greater than the timeslice, then the process needs to be preempted
+                // The timeslice is the quantum, except for CFS where it depends on the ready processes
+                int timeslice = static_cast<SchedulerType *>(cpu->scheduler)->SchedulerType::getTimeslice(process);
+                if (currentCpuBurstForExecution > timeslice)
                 {
                     preempt = true;
-                    // Set the current CPU burst for execution as the quantum
-                    currentCpuBurstForExecution = scheduler->quantum;
+                    // Set the current CPU burst for execution as the timeslice
+                    currentCpuBurstForExecution = timeslice;
                 }
                 // If the current CPU burst is greater than the remaining execution time,
                 // then set the current CPU burst as the remaining execution time
@@ -741,14 +2969,19 @@ void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue,
                     event->newState = BLOCKED;
                     event->transition = TO_BLOCKED;
                 }
-                addEvent(event, showEventQueue);
+                addEvent(event, Trace && showEventQueue);
             }
             break;
         }
 
         case TO_BLOCKED: // Must come from RUNNING
-            // Set the currentRunningProcess to NULL as the process is transitioning to the blocked state
-            currentRunningProcess = nullptr;
+            // Set the running process of the CPU to NULL as the process is transitioning to the blocked state
+            cpu->runningProcess = nullptr;
+            cpu->busyTime += timeInPreviousState;
+            static_cast<SchedulerType *>(cpu->scheduler)->SchedulerType::chargeCpuTime(process, timeInPreviousState);
+            // The end of the CPU burst completes a job of a process with a deadline
+            if (hasDeadlines)
+                completeJob(process, currentTime);
             // Call the scheduler to get the next process
             callScheduler = true;
 
@@ -761,13 +2994,14 @@ void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue,
                 // Calculate the time to the next event and set the state timestamp of the process as the current time
                 int timeToNextEvent = currentTime + currentIoBurst;
                 process->stateTimeStamp = currentTime;
+                // Start an I/O busy period when the first process enters I/O
+                if (scheduler->blockedProcesses++ == 0)
+                    scheduler->ioBusyStartTime = currentTime;
 
                 // Print the state transition if the showStateTransition flag is set
-                if (showStateTransition)
-                {
-                    string message = "[ib=" + to_string(currentIoBurst) + " rem=" + to_string(process->remainingCpuTime) + "]";
-                    displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldStateStr, newStateStr, message);
-                }
+                if (Trace && showStateTransition)
+                    displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldState, newState,
+                                           IO_BURST_MESSAGE, currentIoBurst, process->remainingCpuTime);
 
                 // Create an event for the process to transition to READY
                 Event *event = new Event();
@@ -776,7 +3010,7 @@ void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue,
                 event->oldState = BLOCKED;
                 event->newState = READY;
                 event->transition = TO_READY;
-                addEvent(event, showEventQueue);
+                addEvent(event, Trace && showEventQueue);
             }
             else // Process has no remaining CPU time, so it is done executing
             {
@@ -785,8 +3019,11 @@ void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue,
                 // Calculate the turnaround time of the process
                 process->turnaroundTime = currentTime - process->arrivalTime;
                 // Print the state transition if the showStateTransition flag is set
-                if (showStateTransition)
-                    displayStateTransition(currentTime, process->processNumber, timeInPreviousState, "", "");
+                if (Trace && showStateTransition)
+                    displayStateTransition(currentTime, process->processNumber, timeInPreviousState, oldState, newState, DONE_MESSAGE);
+                // Summarize and release the process when streaming
+                if (streamArrivals)
+                    releaseFinishedProcess(process);
             }
             break;
         }
@@ -799,94 +3036,104 @@ void simulate(bool showStateTransition, bool showRunQueue, bool showEventQueue,
                 continue;
 
             callScheduler = false;
-            if (currentRunningProcess == nullptr) // If there is no running process
+            for (int i = 0; i < cpus.size(); i++)
             {
-                // Get the next process from the scheduler
-                currentRunningProcess = scheduler->getNextProcess();
-                if (currentRunningProcess == nullptr) // If there are no more processes in the ready queue
+                if (cpus[i].runningProcess != nullptr) // If the CPU has a running process
+                    continue;
+
+                // Get the next process for the CPU, stealing it from another CPU if its ready queue is empty
+                cpus[i].runningProcess = getNextProcessForCpu<SchedulerType>(i);
+                if (cpus[i].runningProcess == nullptr) // If there are no more processes in the ready queues
                     continue;
+                if (counters != nullptr)
+                    counters->contextSwitches++;
+
+                // Charge the dispatch cost, and the switch cost if the CPU last ran another process
+                int overhead = dispatchCost;
+                if (cpus[i].lastProcessNumber != cpus[i].runningProcess->processNumber)
+                {
+                    overhead += switchCost;
+                    cpus[i].processSwitches++;
+                }
+                cpus[i].lastProcessNumber = cpus[i].runningProcess->processNumber;
+                cpus[i].overheadTime += overhead;
+                cpus[i].dispatches++;
+                cpus[i].dispatchEndTime = currentTime + overhead;
 
-                // Create an event for the process to transition to RUNNING
+                // Create an event for the process to transition to RUNNING once the overhead has passed
                 Event *event = new Event();
-                event->timeStamp = currentTime;
-                event->process = currentRunningProcess;
+                event->timeStamp = currentTime + overhead;
+                event->process = cpus[i].runningProcess;
                 event->oldState = READY;
                 event->newState = RUNNING;
                 event->transition = TO_RUNNING;
-                addEvent(event, showEventQueue);
+                addEvent(event, Trace && showEventQueue);
             }
         }
     }
 }
 
-// A function to compute the total I/O time by merging the overlapping I/O intervals
-void computeSchedulerTotalIoTime()
+// A function to run the simulation instantiated for a scheduler class, with or without verbose output
+template <class SchedulerType>
+void simulateWithScheduler(bool showStateTransition, bool showRunQueue, bool showEventQueue, bool showPreemptionDecision)
 {
-    if (scheduler->ioTimeStamps.empty()) // If there are no I/O time stamps, return
-        return;
-
-    // Sort the intervals based on the start time
-    sort(scheduler->ioTimeStamps.begin(), scheduler->ioTimeStamps.end());
-
-    // Merge overlapping intervals
-    int start = scheduler->ioTimeStamps[0][0];
-    int end = scheduler->ioTimeStamps[0][1];
+    if (showStateTransition || showRunQueue || showEventQueue || showPreemptionDecision)
+        simulate<SchedulerType, true>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+    else
+        simulate<SchedulerType, false>(false, false, false, false);
+}
 
-    // Iterate over the intervals
-    for (int i = 1; i < scheduler->ioTimeStamps.size(); ++i)
+// A function to select the simulation instantiated for the scheduler specification and run it
+void runSimulation(const char *schedulerSpec, bool showStateTransition, bool showRunQueue, bool showEventQueue, bool showPreemptionDecision)
+{
+    switch (schedulerSpec[0])
     {
-        // Check for overlap
-        if (scheduler->ioTimeStamps[i][0] <= end)
-            // Overlapping intervals, update the end time
-            end = max(end, scheduler->ioTimeStamps[i][1]);
-        else
-        {
-            // No overlap, add the duration and reset start and end
-            scheduler->ioTime += end - start;
-            start = scheduler->ioTimeStamps[i][0];
-            end = scheduler->ioTimeStamps[i][1];
-        }
+    case 'F':
+        simulateWithScheduler<FCFS>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
+    case 'L':
+        simulateWithScheduler<LCFS>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
+    case 'S':
+        simulateWithScheduler<SRTF>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
+    case 'R':
+        simulateWithScheduler<RoundRobin>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
+    case 'P':
+        simulateWithScheduler<Priority>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
+    case 'E':
+        simulateWithScheduler<PreemptivePriority>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
+    case 'C':
+        simulateWithScheduler<CompletelyFairScheduler>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
+    case 'T':
+        simulateWithScheduler<StrideScheduler>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
+    case 'O':
+        simulateWithScheduler<LotteryScheduler>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
+    case 'D':
+        simulateWithScheduler<EarliestDeadlineFirst>(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+        break;
     }
-    // Add the last interval
-    scheduler->ioTime += end - start;
 }
 
 // A function to display the process information
 void displayProcessInfo()
 {
-    // Variables to store summary statistics
-    int simulationFinishTime = 0, totalTurnaroundTime = 0, totalWaitTime = 0, totalProcesses = processes.size();
-    // Print the process information
-    cout << scheduler->name << endl;
-    for (int i = 0; i < totalProcesses; i++)
+    // Print the process information. When streaming, the processes were already summarized as they finished
+    if (!streamArrivals)
     {
-        Process *process = processes[i];
-
-        cout << setw(4) << setfill('0') << process->processNumber << ": "
-             << setw(4) << setfill(' ') << process->arrivalTime << " "
-             << setw(4) << process->cpuTime << " "
-             << setw(4) << process->cpuBurst << " "
-             << setw(4) << process->ioBurst << " "
-             << setw(1) << process->staticPriority << " | "
-             << setw(5) << process->finishTime << " "
-             << setw(5) << process->turnaroundTime << " "
-             << setw(5) << process->ioTime << " "
-             << setw(5) << process->cpuWaitTime << endl;
-
-        // Update the simulation finish time if the current process finish time is greater
-        simulationFinishTime = (process->finishTime > simulationFinishTime)
-                                   ? process->finishTime
-                                   : simulationFinishTime;
-
-        // Update the scheduler statistics from the current process
-        scheduler->cpuTime += process->cpuTime;
-        totalTurnaroundTime += process->turnaroundTime;
-        totalWaitTime += process->cpuWaitTime;
+        cout << scheduler->name << endl;
+        for (int i = 0; i < processes.size(); i++)
+            displayProcess(processes[i]);
     }
 
     // Calculate the summary statistics
-    computeSchedulerTotalIoTime();
-    double cpuUtilization = 100.0 * (scheduler->cpuTime / (double)simulationFinishTime);
+    double cpuUtilization = 100.0 * (scheduler->cpuTime / ((double)simulationFinishTime * cpus.size()));
     double ioUtilization = 100.0 * (scheduler->ioTime / (double)simulationFinishTime);
     double throughput = 100.0 * (totalProcesses / (double)simulationFinishTime);
     double avgTurnaroundTime = totalTurnaroundTime / (double)totalProcesses;
@@ -898,6 +3145,67 @@ void displayProcessInfo()
          << fixed << setprecision(2) << avgTurnaroundTime << " "
          << fixed << setprecision(2) << avgWaitTime << " "
          << fixed << setprecision(3) << throughput << endl;
+
+    // Print the per-CPU utilization and migrations for multi-CPU simulation
+    if (cpus.size() > 1)
+        for (int i = 0; i < cpus.size(); i++)
+            cout << "CPU" << i << ": "
+                 << fixed << setprecision(2) << 100.0 * (cpus[i].busyTime / (double)simulationFinishTime) << " "
+                 << cpus[i].migrations << endl;
+
+    // Print the time the CPUs spent dispatching and switching processes, apart from the CPU utilization
+    if (dispatchCost > 0 || switchCost > 0)
+    {
+        long long overheadTime = 0, dispatches = 0, processSwitches = 0;
+        for (int i = 0; i < cpus.size(); i++)
+        {
+            overheadTime += cpus[i].overheadTime;
+            dispatches += cpus[i].dispatches;
+            processSwitches += cpus[i].processSwitches;
+        }
+        cout << "OVERHEAD: time=" << overheadTime
+             << " util=" << fixed << setprecision(2) << 100.0 * (overheadTime / ((double)simulationFinishTime * cpus.size()))
+             << " dispatches=" << dispatches << " switches=" << processSwitches << endl;
+    }
+
+    // Print the global latency distributions in the extended summary
+    if (recordLatencies)
+    {
+        displayLatencyPercentiles("WAIT", waitTimes);
+        cout << endl;
+        displayLatencyPercentiles("RESPONSE", responseTimes);
+        cout << endl;
+        displayLatencyPercentiles("IO", ioBursts);
+        cout << endl;
+    }
+
+    // Print the deadline statistics of all the jobs if any process has a deadline
+    if (hasDeadlines)
+    {
+        displayDeadlineStatistics("DEADLINE", totalDeadline);
+        cout << endl;
+    }
+}
+
+// A function to write the performance counters as JSON
+void writeCountersJson(FILE *file)
+{
+    fprintf(file, "{\n");
+    fprintf(file, "  \"scheduler\": \"%s\",\n", scheduler->name.c_str());
+    fprintf(file, "  \"cpus\": %d,\n", (int)cpus.size());
+    fprintf(file, "  \"events\": {\"processed\": %d, \"TO_READY\": %lld, \"TO_RUNNING\": %lld, \"TO_BLOCKED\": %lld, \"TO_PREEMPT\": %lld},\n",
+            eventsProcessed, counters->eventsProcessed[TO_READY], counters->eventsProcessed[TO_RUNNING],
+            counters->eventsProcessed[TO_BLOCKED], counters->eventsProcessed[TO_PREEMPT]);
+    fprintf(file, "  \"eventQueue\": {\"adds\": %lld, \"probes\": %lld, \"appends\": %lld, \"maxLength\": %lld},\n",
+            counters->eventsAdded, counters->eventInsertProbes, counters->eventsAppended, counters->maxEventQueueLength);
+    fprintf(file, "  \"preemption\": {\"checks\": %lld, \"preemptions\": %lld},\n",
+            counters->preemptionChecks, counters->preemptions);
+    fprintf(file, "  \"contextSwitches\": %lld,\n", counters->contextSwitches);
+    fprintf(file, "  \"readyQueueHighWater\": %lld,\n", counters->readyQueueHighWater);
+    fprintf(file, "  \"phaseMicroseconds\": {\"readRandomFile\": %.1f, \"readInputFile\": %.1f, \"simulate\": %.1f, \"displayProcessInfo\": %.1f}\n",
+            counters->phaseMicroseconds[READ_RANDOM_FILE_PHASE], counters->phaseMicroseconds[READ_INPUT_FILE_PHASE],
+            counters->phaseMicroseconds[SIMULATE_PHASE], counters->phaseMicroseconds[DISPLAY_PROCESS_INFO_PHASE]);
+    fprintf(file, "}\n");
 }
 
 // A function to parse the scheduler specification and return the time quantum and the maximum number of priorities
@@ -913,8 +3221,9 @@ void parseSchedulerSpecificationNumMaxprios(int *quantum, int *maxprios, char *s
 }
 
 // A function to initialise the scheduler based on the scheduler specification
-void initScheduler(char *schedulerSpec)
+Scheduler *initScheduler(char *schedulerSpec)
 {
+    Scheduler *scheduler = nullptr;
     int quantum = 10000, maxprios = 4; // Default values for quantum and maxprios
     if (schedulerSpec[0] == 'F')       // FCFS
         scheduler = new FCFS();
@@ -940,14 +3249,68 @@ void initScheduler(char *schedulerSpec)
         parseSchedulerSpecificationNumMaxprios(&quantum, &maxprios, schedulerSpec);
         scheduler = new PreemptivePriority(quantum, maxprios);
     }
+    else if (schedulerSpec[0] == 'C') // Completely Fair Scheduler
+    {
+        // Extract the target latency and maxprios if specified
+        quantum = CFS_DEFAULT_TARGET_LATENCY;
+        if (schedulerSpec[1] != '\0')
+            parseSchedulerSpecificationNumMaxprios(&quantum, &maxprios, schedulerSpec);
+        scheduler = new CompletelyFairScheduler(quantum, maxprios);
+    }
+    else if (schedulerSpec[0] == 'T') // Stride
+    {
+        // Extract the quantum and maxprios
+        parseSchedulerSpecificationNumMaxprios(&quantum, &maxprios, schedulerSpec);
+        scheduler = new StrideScheduler(quantum, maxprios);
+    }
+    else if (schedulerSpec[0] == 'O') // Lottery
+    {
+        // Extract the quantum and maxprios
+        parseSchedulerSpecificationNumMaxprios(&quantum, &maxprios, schedulerSpec);
+        scheduler = new LotteryScheduler(quantum, maxprios);
+    }
+    else if (schedulerSpec[0] == 'D') // Earliest Deadline First
+    {
+        // Extract the quantum and maxprios if specified
+        if (schedulerSpec[1] != '\0')
+            parseSchedulerSpecificationNumMaxprios(&quantum, &maxprios, schedulerSpec);
+        scheduler = new EarliestDeadlineFirst(quantum, maxprios);
+    }
+    return scheduler;
+}
+
+// A function to initialise the CPUs, each with its own scheduler built from the scheduler specification
+void initCpus(const char *schedulerSpec, int numCpus)
+{
+    for (int i = 0; i < numCpus; i++)
+    {
+        // Copy the specification as it is tokenised while parsing
+        string spec = schedulerSpec;
+        Cpu cpu = Cpu();
+        cpu.cpuNumber = i;
+        cpu.scheduler = initScheduler(&spec[0]);
+        cpus.push_back(cpu);
+    }
+    // The scheduler of the first CPU keeps the global accounting
+    scheduler = cpus[0].scheduler;
 }
 
+// The main function is left out when the scheduler classes are built into the benchmark
+#ifndef SCHEDULER_BENCHMARK
 // Main function
 int main(int argc, char *argv[])
 {
     int opt;
     bool showHelp = false, showStateTransition = false, showRunQueue = false, showEventQueue = false, showPreemptionDecision = false;
-    const char *optstring = "hvteps:";
+    const char *optstring = "hvteplRxc:b:d:j:k:o:q:r:s:L:";
+    const char *schedulerSpec = "F";     // The scheduler specification, FCFS by default
+    int numCpus = 1;                     // The number of CPUs
+    bool streamInput = false;            // Whether the arrivals are streamed from the input file
+    bool useRandomCache = false;         // Whether the binary sidecar of the random file is used
+    const char *traceFileName = NULL;    // The binary trace file the verbose output is written to
+    const char *countersFileName = NULL; // The JSON file the performance counters are written to
+    char *checkpointSpec = NULL;         // The checkpoint specification, e<count>:<file> or t<time>:<file>
+    FILE *resumeFile = NULL;             // The checkpoint file to resume from
 
     // Parse the command line arguments
     while ((opt = getopt(argc, argv, optstring)) != -1)
@@ -967,13 +3330,88 @@ int main(int argc, char *argv[])
             showEventQueue = true; // Show event queue
             break;
         case 'p':
-            showPreemptionDecision = true; // Show preemption decision for PREPRIO
+            showPreemptionDecision = true; // Show preemption decision for PREPRIO, CFS and EDF
+            break;
+        case 'R':
+            useRandomCache = true; // Use the binary sidecar of the random file
+            break;
+        case 'x':
+            recordLatencies = true; // Record the latency distributions for the extended summary
+            break;
+        case 'l':
+            streamInput = true; // Stream the arrivals lazily from the input file
+            break;
+        case 'L':
+            rollingPeriod = atoi(optarg); // Feed the arrivals live through a producer thread
+            if (rollingPeriod < 1)
+            {
+                cout << "Error: Rolling statistics period must be at least 1. Use -h for help." << endl;
+                exit(1);
+            }
+            nextRollingTime = rollingPeriod;
+            break;
+        case 'c':
+            numCpus = atoi(optarg); // Number of CPUs to simulate
+            if (numCpus < 1)
+            {
+                cout << "Error: Number of CPUs must be at least 1. Use -h for help." << endl;
+                exit(1);
+            }
+            break;
+        case 'b':
+            traceFileName = optarg; // Write the verbose output as binary trace records
+            break;
+        case 'd':
+        {
+            // Decode a binary trace file to the verbose text output and exit
+            FILE *traceFile = fopen(optarg, "rb");
+            if (traceFile == NULL)
+            {
+                cout << "Error: Cannot open trace file. Use -h for help." << endl;
+                exit(1);
+            }
+            decodeTraceFile(traceFile);
+            fclose(traceFile);
+            exit(0);
+        }
+        case 'j':
+            countersFileName = optarg; // Collect the performance counters and write them as JSON
+            break;
+        case 'k':
+            checkpointSpec = optarg; // Write a checkpoint at the given event count or time
+            break;
+        case 'o':
+            // Cost of dispatching a process, and of switching to a different process than the last one
+            if (sscanf(optarg, "%d:%d", &dispatchCost, &switchCost) < 1 || dispatchCost < 0 || switchCost < 0)
+            {
+                cout << "Error: Invalid dispatch cost. Use -h for help." << endl;
+                exit(1);
+            }
+            break;
+        case 'q':
+            // Event queue implementation, the sorted vector by default or the calendar queue
+            if (strcmp(optarg, "c") == 0)
+                calendarQueue = new CalendarQueue();
+            else if (strcmp(optarg, "v") != 0)
+            {
+                cout << "Error: Invalid event queue. Use -h for help." << endl;
+                exit(1);
+            }
+            break;
+        case 'r':
+            // Resume the simulation from a checkpoint file
+            resumeFile = fopen(optarg, "rb");
+            if (resumeFile == NULL)
+            {
+                cout << "Error: Cannot open checkpoint file. Use -h for help." << endl;
+                exit(1);
+            }
             break;
         case 's':
-            initScheduler(optarg); // Initialise the scheduler based on the scheduler specification
+            schedulerSpec = optarg; // Scheduler specification, the CPUs are initialised after parsing
             break;
         default:
-            cout << "Usage: " << argv[0] << " [-h] [-v] [-t] [-e] [-p] [-s <scheduler>] inputFile randFile" << endl;
+            cout << "Usage: " << argv[0] << " [-h] [-v] [-t] [-e] [-p] [-l] [-L <period>] [-R] [-x] [-c <ncpus>] [-b <tracefile>] [-d <tracefile>] [-j <countersfile>] [-k <checkpointspec>] [-o <dispatch>[:<switch>]] [-q <eventqueue>] [-r <checkpointfile>] [-s <scheduler>] inputFile randFile" << endl;
             exit(1);
         }
     }
@@ -981,19 +3419,34 @@ int main(int argc, char *argv[])
     // Show the help message if the -h flag is set
     if (showHelp)
     {
-        cout << "Usage: " << argv[0] << " [-h] [-v] [-t] [-e] [-p] [-s <schedspec>] inputfile randfile" << endl;
+        cout << "Usage: " << argv[0] << " [-h] [-v] [-t] [-e] [-p] [-l] [-L <period>] [-R] [-x] [-c <ncpus>] [-b <tracefile>] [-d <tracefile>] [-j <countersfile>] [-k <checkpointspec>] [-o <dispatch>[:<switch>]] [-q <eventqueue>] [-r <checkpointfile>] [-s <schedspec>] inputfile randfile" << endl;
         cout << "Options:" << endl;
         cout << "  -h        show help message" << endl;
         cout << "  -v        show state transitions" << endl;
         cout << "  -t        show run queue after insertion" << endl;
         cout << "  -e        show event queue before and after insertion" << endl;
-        cout << "  -p        show preemption decision for PREPRIO" << endl;
-        cout << "  -s        scheduler specification (FLS | R<num> | P<num>[:<maxprio>] | E<num>[:<maxprios>])\n";
+        cout << "  -p        show preemption decision for PREPRIO, CFS and EDF" << endl;
+        cout << "  -l        stream arrivals from the input file sorted by arrival time. Processes are summarized in input order," << endl;
+        cout << "            so the processes finishing after the oldest unfinished one stay in memory until that one finishes" << endl;
+        cout << "  -L        live mode: a producer thread feeds the arrivals as they are written to the input file," << endl;
+        cout << "            e.g. a named pipe, and rolling statistics are published every <period> of simulated time" << endl;
+        cout << "  -R        load the random values from the binary sidecar <randfile>.bin, creating it if needed" << endl;
+        cout << "  -x        show the extended summary with wait, response and I/O latency percentiles" << endl;
+        cout << "  -c        number of CPUs, each with its own ready queue (default 1)" << endl;
+        cout << "  -b        write the -v/-t/-e/-p output as binary trace records to a file" << endl;
+        cout << "  -d        decode a binary trace file to the -v/-t/-e/-p output and exit" << endl;
+        cout << "  -j        collect performance counters and phase timings and write them as JSON to a file" << endl;
+        cout << "  -k        write a checkpoint after <count> events or at <time> (e<count>:<file> | t<time>:<file>)" << endl;
+        cout << "  -o        time to dispatch a process, plus <switch> if the CPU last ran a different process (default 0:0)" << endl;
+        cout << "  -q        event queue implementation, v for the sorted vector (default) or c for the calendar queue" << endl;
+        cout << "  -r        resume the simulation from a checkpoint file" << endl;
+        cout << "  -s        scheduler specification (FLS | R<num> | P<num>[:<maxprio>] | E<num>[:<maxprios>] | C[<latency>[:<maxprios>]] | T<num>[:<maxprios>] | O<num>[:<maxprios>] | D[<num>[:<maxprios>]])\n";
         exit(0);
     }
 
     // File pointers for the input and random files
     FILE *inputFile, *randomFile;
+    const char *randomFileName;
     // Check if the input file has been specified
     if (optind < argc)
     {
@@ -1008,7 +3461,8 @@ int main(int argc, char *argv[])
         if (optind < argc)
         {
             // Open the random file
-            randomFile = fopen(argv[optind++], "r");
+            randomFileName = argv[optind++];
+            randomFile = fopen(randomFileName, "r");
             if (randomFile == NULL) // Check if the random file can be opened
             {
                 cout << "Error: Cannot open random file. Use -h for help." << endl;
@@ -1027,21 +3481,131 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
+    // Open the binary trace file if specified
+    FILE *traceFile = NULL;
+    if (traceFileName != NULL)
+    {
+        traceFile = fopen(traceFileName, "wb");
+        if (traceFile == NULL) // Check if the trace file can be opened
+        {
+            cout << "Error: Cannot open trace file. Use -h for help." << endl;
+            exit(1);
+        }
+        traceBuffer = new TraceBuffer(traceFile);
+    }
+
+    // Open the performance counters file if specified
+    FILE *countersFile = NULL;
+    if (countersFileName != NULL)
+    {
+        countersFile = fopen(countersFileName, "w");
+        if (countersFile == NULL) // Check if the counters file can be opened
+        {
+            cout << "Error: Cannot open counters file. Use -h for help." << endl;
+            exit(1);
+        }
+        counters = new SchedulerCounters();
+    }
+    double phaseStart = wallClockMicroseconds();
+
+    // Checkpoints are not supported when streaming, as finished processes are already summarized and released
+    if ((streamInput || rollingPeriod > 0) && (checkpointSpec != NULL || resumeFile != NULL))
+    {
+        cout << "Error: Checkpoints cannot be used with streamed arrivals. Use -h for help." << endl;
+        exit(1);
+    }
+
+    // Open the checkpoint file to write if specified
+    if (checkpointSpec != NULL)
+    {
+        char *when = strtok(checkpointSpec, ":");
+        char *checkpointFileName = strtok(NULL, "");
+        if (checkpointFileName == NULL || (when[0] != 'e' && when[0] != 't'))
+        {
+            cout << "Error: Invalid checkpoint specification. Use -h for help." << endl;
+            exit(1);
+        }
+        if (when[0] == 'e')
+            checkpointEventCount = atoi(when + 1);
+        else
+            checkpointTime = atoi(when + 1);
+        checkpointFile = fopen(checkpointFileName, "wb");
+        if (checkpointFile == NULL) // Check if the checkpoint file can be opened
+        {
+            cout << "Error: Cannot open checkpoint file. Use -h for help." << endl;
+            exit(1);
+        }
+    }
+
+    // When resuming, the scheduler specification, the number of CPUs and latency recording are taken from the checkpoint
+    checkpointSchedulerSpec = schedulerSpec;
+    if (resumeFile != NULL)
+        readCheckpointConfiguration(resumeFile, &numCpus);
+
+    // Initialise the CPUs and their schedulers
+    initCpus(checkpointSchedulerSpec.c_str(), numCpus);
+
     // Read the random values from the random file
-    readRandomFile(randomFile);
+    phaseStart = wallClockMicroseconds();
+    readRandomFile(randomFile, randomFileName, useRandomCache);
+    endPhase(READ_RANDOM_FILE_PHASE, &phaseStart);
 
-    // Read the input file and populate the eventQueue
-    readInputFile(inputFile, scheduler->maxprios, showEventQueue);
+    if (resumeFile != NULL)
+    {
+        // Restore the simulation state from the checkpoint
+        readCheckpoint(resumeFile);
+        fclose(resumeFile);
+    }
+    else if (rollingPeriod > 0)
+    {
+        // Feed the arrivals live from the producer thread. The processes are summarized as they finish
+        startLiveArrivals(inputFile, scheduler->maxprios);
+        cout << scheduler->name << endl;
+        readNextArrival(showEventQueue);
+    }
+    else if (streamInput)
+    {
+        // Stream the arrivals from the input file. The processes are summarized as they finish
+        startStreamingInputFile(inputFile, scheduler->maxprios);
+        cout << scheduler->name << endl;
+        readNextArrival(showEventQueue);
+    }
+    else
+        // Read the input file and populate the eventQueue
+        readInputFile(inputFile, scheduler->maxprios, showEventQueue);
+    endPhase(READ_INPUT_FILE_PHASE, &phaseStart);
 
     // Run the event simulation
-    simulate(showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+    runSimulation(checkpointSchedulerSpec.c_str(), showStateTransition, showRunQueue, showEventQueue, showPreemptionDecision);
+    endPhase(SIMULATE_PHASE, &phaseStart);
+
+    // The producer thread of live mode is done once the simulation has consumed its last arrival
+    if (liveProducer != nullptr)
+        liveProducer->join();
 
     // Close the input and random files
     fclose(inputFile);
     fclose(randomFile);
 
+    // Flush and close the binary trace file
+    if (traceFile != NULL)
+    {
+        traceBuffer->flush();
+        fclose(traceFile);
+    }
+
     // Print the process statistics
+    phaseStart = wallClockMicroseconds();
     displayProcessInfo();
+    endPhase(DISPLAY_PROCESS_INFO_PHASE, &phaseStart);
+
+    // Write the performance counters
+    if (countersFile != NULL)
+    {
+        writeCountersJson(countersFile);
+        fclose(countersFile);
+    }
 
     return 0;
 }
+#endif
@@ -3,7 +3,19 @@
 #include <cstring>
 #include <cctype>
 #include <deque>
+#include <vector>
+#include <string>
 #include <algorithm>
+#include <cstdint>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <iomanip>
+#include "../common/randomfile.h"
 
 using namespace std;
 
@@ -11,17 +23,18 @@ using namespace std;
 class VMA
 {
 public:
-    int startPage;       // The start page of the virtual memory area
-    int endPage;         // The end page of the virtual memory area
+    uint32_t startPage;  // The start page of the virtual memory area
+    uint32_t endPage;    // The end page of the virtual memory area
     bool writeProtected; // The write protection status of the virtual memory area
     bool fileMapped;     // The file mapping status of the virtual memory area
 };
 
 // A Page Table Entry (PTE) class to store the page table entry information
+// The frame number takes all the bits left by the flags, so that a PTE still fits in 32 bits
 class PTE
 {
 public:
-    uint32_t FRAME : 7;         // The frame number
+    uint32_t FRAME : 26;        // The frame number
     uint32_t PRESENT : 1;       // The present bit
     uint32_t MODIFIED : 1;      // The modified bit
     uint32_t REFERENCED : 1;    // The referenced bit
@@ -30,32 +43,144 @@ public:
     uint32_t FILE_MAPPED : 1;   // The file-mapped bit
 };
 
+// Variables to store the limits of the virtual address space and the frame table
+const uint64_t MAX_VIRTUAL_PAGES = 1ULL << 32; // The largest virtual address space, in pages
+const int MAX_FRAME_COUNT = 1 << 26;           // The largest number of frames a PTE can address
+uint64_t numVirtualPages = 64;                 // The size of the virtual address space of every process, in pages
+
+// Variables to store the shape of the page tables
+const int PAGE_TABLE_LEAF_BITS = 10;   // A leaf table covers at most 1024 pages, 4 KB of page table entries
+const int PAGE_TABLE_MIDDLE_BITS = 10; // A middle directory holds at most 1024 leaf tables
+
+// A PageTable class to store the page table entries of a process in three levels
+// The root directory holds one middle directory for each range of 2^20 pages, and a middle directory holds one
+// leaf table for each range of 1024 pages. Middle directories and leaf tables are allocated when a page of their
+// range is first mapped, so a large address space only pays for the ranges its mapped pages fall in, and a
+// small address space has a single leaf table
+class PageTable
+{
+public:
+    int leafBits;        // The number of low page bits that index a leaf table
+    int middleBits;      // The number of page bits above them that index a middle directory
+    uint32_t leafSize;   // The number of entries in a leaf table
+    uint32_t middleSize; // The number of leaf tables in a middle directory
+    vector<PTE **> root; // The middle directories, nullptr until one of their pages is mapped
+
+    PageTable(uint64_t numPages)
+    {
+        int pageBits = 0;
+        while ((1ULL << pageBits) < numPages)
+            pageBits++;
+        leafBits = min(pageBits, PAGE_TABLE_LEAF_BITS);
+        middleBits = min(pageBits - leafBits, PAGE_TABLE_MIDDLE_BITS);
+        leafSize = min<uint64_t>(numPages, 1ULL << leafBits);
+        middleSize = 1U << middleBits;
+        int rootBits = leafBits + middleBits;
+        root = vector<PTE **>((numPages + (1ULL << rootBits) - 1) >> rootBits, nullptr);
+    }
+
+    ~PageTable()
+    {
+        for (PTE **middle : root)
+        {
+            if (middle == nullptr)
+                continue;
+            for (uint32_t i = 0; i < middleSize; i++)
+                delete[] middle[i];
+            delete[] middle;
+        }
+    }
+
+    PageTable(const PageTable &) = delete;
+    PageTable &operator=(const PageTable &) = delete;
+
+    // Return the page table entry of a page, allocating its middle directory and leaf table if needed
+    PTE &operator[](uint32_t vpage)
+    {
+        PTE **&middle = root[(uint64_t)vpage >> (leafBits + middleBits)];
+        if (middle == nullptr)
+            middle = new PTE *[middleSize]();
+        PTE *&leaf = middle[(vpage >> leafBits) & (middleSize - 1)];
+        if (leaf == nullptr)
+            leaf = new PTE[leafSize]();
+        return leaf[vpage & ((1U << leafBits) - 1)];
+    }
+
+    // Return the page table entry of a page, or nullptr if its leaf table was never allocated
+    PTE *find(uint32_t vpage)
+    {
+        PTE **middle = root[(uint64_t)vpage >> (leafBits + middleBits)];
+        if (middle == nullptr)
+            return nullptr;
+        PTE *leaf = middle[(vpage >> leafBits) & (middleSize - 1)];
+        return leaf != nullptr ? &leaf[vpage & ((1U << leafBits) - 1)] : nullptr;
+    }
+
+    // Return the last page of the unallocated range holding a page that find() did not find,
+    // which is the rest of its middle directory if that was never allocated, and of its leaf table otherwise
+    uint64_t getUnallocatedRangeEnd(uint32_t vpage)
+    {
+        int bits = root[(uint64_t)vpage >> (leafBits + middleBits)] == nullptr ? leafBits + middleBits : leafBits;
+        return vpage | ((1ULL << bits) - 1);
+    }
+};
+
 // A Process class to store the process information
 class Process
 {
 public:
-    int processNumber;     // The process number
-    vector<VMA> vmas;      // The virtual memory areas
-    vector<PTE> pageTable; // The page table for the process
-    int unmaps;            // The number of unmaps
-    int maps;              // The number of maps
-    int ins;               // The number of ins
-    int outs;              // The number of outs
-    int fins;              // The number of fins
-    int fouts;             // The number of fouts
-    int zeros;             // The number of zeros
-    int segv;              // The number of segv
-    int segprot;           // The number of segprot
+    int processNumber;                                // The process number
+    vector<VMA> vmas;                                 // The virtual memory areas
+    vector<int> vmaIndex;                             // The positions of the VMAs in vmas, sorted by start page
+    bool overlappingVMAs;                             // Whether two VMAs overlap, so vmaIndex cannot be searched
+    PageTable pageTable = PageTable(numVirtualPages); // The page table for the process
+    int unmaps;                                       // The number of unmaps
+    int maps;                                         // The number of maps
+    int ins;                                          // The number of ins
+    int outs;                                         // The number of outs
+    int fins;                                         // The number of fins
+    int fouts;                                        // The number of fouts
+    int zeros;                                        // The number of zeros
+    int segv;                                         // The number of segv
+    int segprot;                                      // The number of segprot
+
+    // A function to sort the VMAs by start page once they are read, so that page faults can binary search them
+    void buildVMAIndex()
+    {
+        vmaIndex = vector<int>(vmas.size());
+        for (int i = 0; i < vmas.size(); i++)
+            vmaIndex[i] = i;
+        stable_sort(vmaIndex.begin(), vmaIndex.end(), [this](int a, int b)
+                    { return vmas[a].startPage < vmas[b].startPage; });
+        overlappingVMAs = false;
+        for (int i = 1; i < vmaIndex.size(); i++)
+        {
+            if (vmas[vmaIndex[i]].startPage <= vmas[vmaIndex[i - 1]].endPage)
+                overlappingVMAs = true;
+        }
+    }
 
     // A function to fetch the VMA in which the page is present
-    VMA *getVMAForPage(int vpage)
+    // Overlapping VMAs are scanned in input order, so the first VMA listed for the page is still the one returned
+    VMA *getVMAForPage(uint32_t vpage)
     {
-        for (VMA &vma : vmas)
+        if (overlappingVMAs)
         {
-            if (vpage >= vma.startPage && vpage <= vma.endPage)
-                return &vma;
+            for (VMA &vma : vmas)
+            {
+                if (vpage >= vma.startPage && vpage <= vma.endPage)
+                    return &vma;
+            }
+            return nullptr;
         }
-        return nullptr;
+
+        // Find the last VMA that starts at or before the page
+        auto next = upper_bound(vmaIndex.begin(), vmaIndex.end(), vpage, [this](uint32_t page, int i)
+                                { return page < vmas[i].startPage; });
+        if (next == vmaIndex.begin())
+            return nullptr;
+        VMA &vma = vmas[*(next - 1)];
+        return vpage <= vma.endPage ? &vma : nullptr;
     }
 };
 
@@ -67,7 +192,6 @@ public:
     uint32_t processNumber; // The process number
     uint32_t pageNumber;    // The page number
     uint32_t timeOfLastUse; // The time of last use
-    uint32_t age;           // The aging bit vector
 };
 
 // An Instruction class to store the instruction information
@@ -75,21 +199,24 @@ class Instruction
 {
 public:
     char operation; // The operation (c/r/w/e)
-    int num;        // The number associated with the operation. Can be procid or vpage
+    uint32_t num;   // The number associated with the operation. Can be procid or vpage
 };
 
-// Variables to store the maximum number of virtual pages and frames
-const int MAX_VPAGES = 64;
-int MAX_FRAMES;
+// The state of a simulation is thread local, so that several simulations of the same trace with different
+// algorithms and frame counts run side by side on their own threads, each with its own frame table,
+// processes and pager
+
+// A variable to store the number of frames
+thread_local int MAX_FRAMES;
 
 // A global vector to represent the frame table
-vector<Frame> frameTable;
+thread_local vector<Frame> frameTable;
 
 // A global deque to represent the free frames
-deque<Frame *> freeFrames = deque<Frame *>();
+thread_local deque<Frame *> freeFrames = deque<Frame *>();
 
 // A global vector to represent the processes
-vector<Process *> processes;
+thread_local vector<Process *> processes;
 
 // A Pager base class to implement the page replacement algorithms
 class Pager
@@ -99,6 +226,8 @@ public:
     unsigned long currentTime = 0;                               // The current time, set to the instruction count
     virtual Frame *selectVictimFrame(bool displayAgingFlag) = 0; // Select the victim frame to replace
     virtual void resetAge(Frame *frame) = 0;                     // Reset the aging bit vector
+    virtual void pageBitsChanged(Frame *frame, PTE *pte) {}      // Follow a change of the bits of a mapped page
+    virtual ~Pager() {}                                          // Release the pager through the base class
 
     // A function to allocate a frame from the free list
     Frame *allocateFrameFromFreeList()
@@ -155,10 +284,6 @@ public:
     }
 };
 
-// Variables to store random values and the random index offset
-int *randomValues;
-int MAX_RANDOM_VALUES_LENGTH;
-
 // The Random Pager class to implement the Random page replacement algorithm
 class Random : public Pager
 {
@@ -221,154 +346,235 @@ public:
     }
 };
 
+// A FrameSet class to store a set of frame numbers as a bitmap with a summary of its non-empty words
+// Finding the next member after a frame skips 64 empty words at a time through the summary
+class FrameSet
+{
+public:
+    int size;                 // The number of frames the set can hold
+    vector<uint64_t> words;   // The bitmap of the members
+    vector<uint64_t> summary; // The bitmap of the non-empty words
+    int count = 0;            // The number of members
+
+    FrameSet(int size) : size(size), words((size + 63) / 64, 0), summary((size + 4095) / 4096, 0) {}
+
+    // A function to add a frame to the set
+    void insert(int frame)
+    {
+        words[frame >> 6] |= 1ULL << (frame & 63);
+        summary[frame >> 12] |= 1ULL << ((frame >> 6) & 63);
+        count++;
+    }
+
+    // A function to remove a frame from the set
+    void erase(int frame)
+    {
+        words[frame >> 6] &= ~(1ULL << (frame & 63));
+        if (words[frame >> 6] == 0)
+            summary[frame >> 12] &= ~(1ULL << ((frame >> 6) & 63));
+        count--;
+    }
+
+    // A function to find the first member at or after a frame, or -1 if there is none
+    int next(int frame)
+    {
+        if (frame >= size)
+            return -1;
+        int word = frame >> 6;
+        uint64_t bits = words[word] & (~0ULL << (frame & 63));
+        if (bits != 0)
+            return (word << 6) + __builtin_ctzll(bits);
+
+        // Find the next non-empty word through the summary
+        word++;
+        if (word >= words.size())
+            return -1;
+        uint64_t wordBits = summary[word >> 6] & (~0ULL << (word & 63));
+        for (int i = word >> 6; ; wordBits = summary[i])
+        {
+            if (wordBits != 0)
+            {
+                word = (i << 6) + __builtin_ctzll(wordBits);
+                return (word << 6) + __builtin_ctzll(words[word]);
+            }
+            if (++i >= summary.size())
+                return -1;
+        }
+    }
+};
+
 // An Enhanced Second Chance Pager class to implement the Enhanced Second Chance page replacement algorithm
+// The frames are kept in one set for each class 2 * REFERENCED + MODIFIED, updated whenever the bits of a page
+// change, so a victim is the first frame of the lowest non-empty class from the current index, found without
+// inspecting every frame. Resetting the reference bits only visits the frames of the referenced classes
 class ESC : public Pager
 {
     int lastReset = -1; // The instruction number of the last reset
     int interval = 47;  // The number of instructions before resetting the reference bits
 public:
-    void resetAge(Frame *frame) {} // No implementation needed
+    vector<FrameSet> classes = vector<FrameSet>(4, FrameSet(MAX_FRAMES)); // The frames of each class
+    vector<int> frameClasses = vector<int>(MAX_FRAMES, -1);              // The class of each frame, -1 if unmapped
+    vector<PTE *> entries = vector<PTE *>(MAX_FRAMES, nullptr);          // The page table entry of each frame
+
+    // A function to move a frame to a class
+    void moveFrame(int frame, int classIndex)
+    {
+        if (frameClasses[frame] != -1)
+            classes[frameClasses[frame]].erase(frame);
+        classes[classIndex].insert(frame);
+        frameClasses[frame] = classIndex;
+    }
+
+    // A function to put a newly mapped frame in the class of its page, caching its page table entry
+    void resetAge(Frame *frame)
+    {
+        PTE *pte = &processes[frame->processNumber]->pageTable[frame->pageNumber];
+        entries[frame->frameNumber] = pte;
+        moveFrame(frame->frameNumber, 2 * pte->REFERENCED + pte->MODIFIED);
+    }
+
+    // A function to move a frame to its new class when the bits of its page change
+    void pageBitsChanged(Frame *frame, PTE *pte)
+    {
+        moveFrame(frame->frameNumber, 2 * pte->REFERENCED + pte->MODIFIED);
+    }
 
     // Select the victim frame to replace
     Frame *selectVictimFrame(bool displayAgingFlag)
     {
-        // Initialise vectors to store the class frames and their indices
-        Frame *victimFrame = nullptr;
-        vector<Frame *> classFrames = vector<Frame *>(4, nullptr);
-        vector<int> classFrameIndices = vector<int>(4, -1);
         // Set the start index and the number of instructions since the last reset
         int startIndex = index,
-            inspectedFrames = 0,
             lowestClassIndex = -1,
+            victimFrameIndex = -1,
             instructionsSinceLastReset = currentTime - lastReset;
         bool resetFlag = false;
-        do
-        {
-            Frame *frame = &frameTable[index];
-            PTE *pte = &processes[frame->processNumber]->pageTable[frame->pageNumber];
-            // Calculate the class index
-            int classIndex = 2 * pte->REFERENCED + pte->MODIFIED;
 
-            // Check if the class frame is empty
-            if (classFrames[classIndex] == nullptr)
-            {
-                // Store the frame and its index
-                classFrames[classIndex] = frame;
-                classFrameIndices[classIndex] = index;
-            }
-
-            // Check if the reference bits need to be reset
-            if (instructionsSinceLastReset > interval)
-            {
-                // Reset the reference bits
-                pte->REFERENCED = 0;
-                // Update the last reset instruction number
-                lastReset = currentTime;
-                // Set the reset flag
-                resetFlag = true;
-            }
-
-            // Move to the next frame
-            index = (index + 1) % MAX_FRAMES;
-            // Increment the number of inspected frames
-            inspectedFrames++;
-        } while (index != startIndex);
-
-        // Select the victim frame as the first non-empty class frame
+        // Select the victim frame as the first frame of the lowest non-empty class, from the current index
         for (int i = 0; i < 4; i++)
         {
-            // Check if the class frame is not empty
-            if (classFrames[i] != nullptr)
+            if (classes[i].count > 0)
             {
-                // Select the victim frame and move to the next frame
-                victimFrame = classFrames[i];
-                index = (classFrameIndices[i] + 1) % MAX_FRAMES;
+                victimFrameIndex = classes[i].next(startIndex);
+                if (victimFrameIndex == -1)
+                    victimFrameIndex = classes[i].next(0);
                 lowestClassIndex = i;
                 break;
             }
         }
 
-        // Display the selected index
+        // Check if the reference bits need to be reset
+        if (instructionsSinceLastReset > interval)
+        {
+            // Reset the reference bits, moving the referenced frames to the unreferenced classes
+            for (int i = 2; i < 4; i++)
+            {
+                for (int frame = classes[i].next(0); frame != -1; frame = classes[i].next(frame + 1))
+                {
+                    entries[frame]->REFERENCED = 0;
+                    moveFrame(frame, i - 2);
+                }
+            }
+            // Update the last reset instruction number
+            lastReset = currentTime;
+            // Set the reset flag
+            resetFlag = true;
+        }
+
+        // Move to the next frame
+        index = (victimFrameIndex + 1) % MAX_FRAMES;
+
+        // Display the selected index, every frame being accounted as inspected
         if (displayAgingFlag)
             cout << "ASELECT: "
                  << startIndex << " " << (int)resetFlag
-                 << " | " << lowestClassIndex << " " << classFrameIndices[lowestClassIndex] << " " << inspectedFrames << endl;
+                 << " | " << lowestClassIndex << " " << victimFrameIndex << " " << MAX_FRAMES << endl;
 
         // Return the selected frame
-        return victimFrame;
+        return &frameTable[victimFrameIndex];
     }
 };
 
+// A vector of ages processed at once by the Aging pager, using the vector extensions of GCC and Clang
+// The vector is only aligned as its elements, so that it can be loaded from any position of the age table
+const int AGE_LANES = 8;
+typedef uint32_t AgeVector __attribute__((vector_size(AGE_LANES * sizeof(uint32_t)), aligned(sizeof(uint32_t))));
+
 // An Aging Pager class to implement the Aging page replacement algorithm
+// The ages and referenced bits are kept in contiguous per-frame arrays, padded to a whole number of vectors,
+// so that aging every frame and finding the smallest age run a vector of frames at a time
 class Aging : public Pager
 {
 public:
-    // Shift the aging bit vector to the right
-    void shiftAgeRight(Frame *frame)
+    int paddedFrames = (MAX_FRAMES + AGE_LANES - 1) / AGE_LANES * AGE_LANES; // The frame count rounded up to vectors
+    vector<uint32_t> ages = vector<uint32_t>(paddedFrames, 0);              // The aging bit vector of each frame
+    vector<uint32_t> referenced = vector<uint32_t>(paddedFrames, 0);        // The referenced bit of each frame
+    vector<PTE *> entries = vector<PTE *>(MAX_FRAMES, nullptr);             // The page table entry of each frame
+
+    // Reset the aging bit vector
+    // The pager is called when a frame is mapped, so the page table entry of the frame is cached here
+    void resetAge(Frame *frame)
     {
-        frame->age = frame->age >> 1;
+        ages[frame->frameNumber] = 0x0;
+        entries[frame->frameNumber] = &processes[frame->processNumber]->pageTable[frame->pageNumber];
     }
 
-    // Set the leading bit of the aging bit vector
-    void setLeadingBit(Frame *frame)
+    // Gather and reset the referenced bits, then shift every age right and set the leading bit if referenced
+    void ageAllFrames()
     {
-        frame->age = frame->age | 0x80000000;
+        for (int i = 0; i < MAX_FRAMES; i++)
+        {
+            referenced[i] = entries[i]->REFERENCED;
+            entries[i]->REFERENCED = 0;
+        }
+        for (int i = 0; i < paddedFrames; i += AGE_LANES)
+        {
+            AgeVector age = *(AgeVector *)&ages[i];
+            AgeVector bit = *(AgeVector *)&referenced[i];
+            *(AgeVector *)&ages[i] = (age >> 1) | (bit << 31);
+        }
     }
 
-    // Reset the aging bit vector
-    void resetAge(Frame *frame)
+    // Find the smallest age, with the padding frames counted as the largest age
+    uint32_t smallestAge()
     {
-        frame->age = 0x0;
+        for (int i = MAX_FRAMES; i < paddedFrames; i++)
+            ages[i] = UINT32_MAX;
+        AgeVector smallest = *(AgeVector *)&ages[0];
+        for (int i = AGE_LANES; i < paddedFrames; i += AGE_LANES)
+        {
+            AgeVector age = *(AgeVector *)&ages[i];
+            AgeVector less = age < smallest;
+            smallest = (age & less) | (smallest & ~less);
+        }
+        uint32_t result = smallest[0];
+        for (int lane = 1; lane < AGE_LANES; lane++)
+            result = min(result, (uint32_t)smallest[lane]);
+        return result;
     }
 
     // Select the victim frame to replace
+    // The victim is the first frame with the smallest age, counting from the current index
     Frame *selectVictimFrame(bool displayAgingFlag)
     {
-        // Initialise the variables to store the victim frame and its index
-        Frame *victimFrame = nullptr;
-        int victimFrameIndex,
-            startIndex = index,
-            smallestAge = UINT32_MAX;
-        string ageString = "";
-
-        do
-        {
-            Frame *frame = &frameTable[index];
-            PTE *pte = &processes[frame->processNumber]->pageTable[frame->pageNumber];
-
-            // Shift the age right
-            shiftAgeRight(frame);
-            // Check if the page is referenced
-            if (pte->REFERENCED)
-            {
-                // Set the leading bit if the page is referenced
-                setLeadingBit(frame);
-                // Reset the referenced bit
-                pte->REFERENCED = 0;
-            }
-
-            // Check if the age is smaller than the smallest age
-            if (frame->age < smallestAge)
-            {
-                // Store the victim frame and its age
-                victimFrame = frame;
-                smallestAge = frame->age;
-                victimFrameIndex = index;
-            }
-            ageString += to_string(frame->frameNumber) + ":" + to_string(frame->age) + " ";
-
-            // Move to the next frame
-            index = (index + 1) % MAX_FRAMES;
-        } while (index != startIndex);
+        ageAllFrames();
+        uint32_t age = smallestAge();
+        int victimFrameIndex = index;
+        while (ages[victimFrameIndex] != age)
+            victimFrameIndex = (victimFrameIndex + 1) % MAX_FRAMES;
 
-        // Display the selected index
+        // Display the selected index and the ages, from the current index around the frame table
         if (displayAgingFlag)
-            cout << "ASELECT: " << startIndex << "-" << index << " | " << ageString << endl;
+        {
+            cout << "ASELECT: " << index << "-" << index << " | ";
+            for (int i = index, n = 0; n < MAX_FRAMES; i = (i + 1) % MAX_FRAMES, n++)
+                cout << i << ":" << ages[i] << " ";
+            cout << endl;
+        }
 
         // Move to the next frame
         index = (victimFrameIndex + 1) % MAX_FRAMES;
         // Return the selected frame
-        return victimFrame;
+        return &frameTable[victimFrameIndex];
     }
 };
 
@@ -450,7 +656,165 @@ public:
 };
 
 // A global pager object to represent the paging algorithm
-Pager *pager;
+thread_local Pager *pager;
+
+// Variables to store the shape of the TLB, set with -t <entries>[:<ways>[:<policy>[:<tagging>]]]
+int tlbEntries = 0;     // The number of TLB entries, or 0 if no TLB is simulated
+int tlbWays = 0;        // The number of entries in each set, equal to tlbEntries for a fully associative TLB
+char tlbPolicy = 'l';   // The replacement policy within a set: l (LRU), f (FIFO) or r (random)
+bool tlbTagged = false; // Whether the entries are tagged with the process number instead of flushed on a switch
+
+// Variables to store the cost of walking the page table on a TLB miss and the tag of an empty TLB entry
+const int TLB_MISS_COST = 20;
+const uint64_t TLB_INVALID_TAG = UINT64_MAX;
+
+// A TLB class to cache the translations of recently used pages in front of the page tables
+// The tags of a set are kept next to each other, so a lookup compares at most tlbWays 64-bit keys. An entry
+// points to the page table entry it caches, which stays valid as leaf tables are never released while a
+// process exists, and it is invalidated whenever the page is unmapped
+class TLB
+{
+public:
+    int numSets;                     // The number of sets
+    vector<uint64_t> tags;           // The process and page of each entry, grouped by set
+    vector<PTE *> entries;           // The page table entry cached by each entry
+    vector<unsigned long> lastUse;   // The lookup count at the last use of each entry, for LRU
+    vector<int> nextVictim;          // The next entry of each set to replace, for FIFO
+    int randomIndex = 0;             // The index into the random values, for random replacement
+    unsigned long lookups = 0;       // The number of lookups
+    unsigned long hits = 0;          // The number of lookups that found the page
+    unsigned long flushes = 0;       // The number of times the whole TLB was flushed
+    unsigned long invalidations = 0; // The number of entries invalidated by unmaps and exits
+    unsigned long long cost = 0;     // The cost added by the TLB misses
+
+    TLB() : numSets(tlbEntries / tlbWays), tags(tlbEntries, TLB_INVALID_TAG), entries(tlbEntries, nullptr),
+            lastUse(tlbEntries, 0), nextVictim(tlbEntries / tlbWays, 0) {}
+
+    // A function to build the tag of a page of a process
+    static uint64_t tag(int processNumber, uint32_t vpage)
+    {
+        return ((uint64_t)processNumber << 32) | vpage;
+    }
+
+    // A function to find the position of the tag in its set, or -1 if it is not cached
+    int find(uint64_t key, uint32_t vpage)
+    {
+        int first = (vpage % numSets) * tlbWays;
+        for (int i = first; i < first + tlbWays; i++)
+        {
+            if (tags[i] == key)
+                return i;
+        }
+        return -1;
+    }
+
+    // A function to look up a page, returning the cached page table entry or nullptr on a miss
+    PTE *lookup(int processNumber, uint32_t vpage)
+    {
+        lookups++;
+        int i = find(tag(processNumber, vpage), vpage);
+        if (i == -1)
+        {
+            cost += TLB_MISS_COST;
+            return nullptr;
+        }
+        hits++;
+        lastUse[i] = lookups;
+        return entries[i];
+    }
+
+    // A function to cache the page table entry of a page after a miss, replacing an entry of its set if needed
+    void insert(int processNumber, uint32_t vpage, PTE *pte)
+    {
+        int set = vpage % numSets, first = set * tlbWays, victim = -1;
+        for (int i = first; i < first + tlbWays && victim == -1; i++)
+        {
+            if (tags[i] == TLB_INVALID_TAG)
+                victim = i;
+        }
+        if (victim == -1)
+        {
+            switch (tlbPolicy)
+            {
+            case 'l': // Replace the least recently used entry
+                victim = first;
+                for (int i = first + 1; i < first + tlbWays; i++)
+                {
+                    if (lastUse[i] < lastUse[victim])
+                        victim = i;
+                }
+                break;
+            case 'f': // Replace the entries of the set in turn
+                victim = first + nextVictim[set];
+                nextVictim[set] = (nextVictim[set] + 1) % tlbWays;
+                break;
+            case 'r': // Replace a random entry, drawing from the random values apart from the pager
+                victim = first + randomValues[randomIndex] % tlbWays;
+                randomIndex = (randomIndex + 1) % MAX_RANDOM_VALUES_LENGTH;
+                break;
+            }
+        }
+        tags[victim] = tag(processNumber, vpage);
+        entries[victim] = pte;
+        lastUse[victim] = lookups;
+    }
+
+    // A function to invalidate the entry of a page when it is unmapped
+    void invalidate(int processNumber, uint32_t vpage)
+    {
+        int i = find(tag(processNumber, vpage), vpage);
+        if (i != -1)
+        {
+            tags[i] = TLB_INVALID_TAG;
+            invalidations++;
+        }
+    }
+
+    // A function to invalidate the entries of a process when it exits
+    void invalidateProcess(int processNumber)
+    {
+        for (uint64_t &key : tags)
+        {
+            if (key != TLB_INVALID_TAG && (int)(key >> 32) == processNumber)
+            {
+                key = TLB_INVALID_TAG;
+                invalidations++;
+            }
+        }
+    }
+
+    // A function to flush the whole TLB on a context switch when the entries are not tagged
+    void flush()
+    {
+        fill(tags.begin(), tags.end(), TLB_INVALID_TAG);
+        flushes++;
+    }
+};
+
+// A global TLB object, or nullptr if no TLB is simulated
+thread_local TLB *tlb = nullptr;
+
+// A function to create a process with an empty page table and no VMAs
+// The page table entries start cleared, as the leaf tables are zeroed when they are allocated
+Process *createProcess(int processNumber)
+{
+    Process *process = new Process();
+    process->processNumber = processNumber;
+    process->vmas = vector<VMA>();
+    process->overlappingVMAs = false;
+
+    // Initialize the process statistics
+    process->unmaps = 0;
+    process->maps = 0;
+    process->ins = 0;
+    process->outs = 0;
+    process->fins = 0;
+    process->fouts = 0;
+    process->zeros = 0;
+    process->segv = 0;
+    process->segprot = 0;
+    return process;
+}
 
 // A function to read the input file and populate the processes and instructions
 void readInput(FILE *inputFile)
@@ -473,25 +837,10 @@ void readInput(FILE *inputFile)
             ;
 
         // Create a new process
-        Process *process = new Process();
-        process->processNumber = i;
+        Process *process = createProcess(i);
 
         // Read the number of virtual memory areas
         numVMA = atoi(line);
-        process->vmas = vector<VMA>();
-        // Initialize the page table for the process
-        process->pageTable = vector<PTE>(MAX_VPAGES);
-
-        // Initialize the process statistics
-        process->unmaps = 0;
-        process->maps = 0;
-        process->ins = 0;
-        process->outs = 0;
-        process->fins = 0;
-        process->fouts = 0;
-        process->zeros = 0;
-        process->segv = 0;
-        process->segprot = 0;
 
         // Read each virtual memory area information
         for (int j = 0; j < numVMA; j++)
@@ -500,54 +849,149 @@ void readInput(FILE *inputFile)
             VMA vma = VMA();
             // Read the virtual memory area information
             fgets(line, 1024, inputFile);
-            vma.startPage = atoi(strtok(line, " "));
-            vma.endPage = atoi(strtok(NULL, " "));
+            vma.startPage = strtoul(strtok(line, " "), NULL, 10);
+            vma.endPage = strtoul(strtok(NULL, " "), NULL, 10);
             vma.writeProtected = atoi(strtok(NULL, " "));
             vma.fileMapped = atoi(strtok(NULL, " "));
             // Add the virtual memory area to the process
             process->vmas.push_back(vma);
         }
-
-        // Initialize the page table for the process
-        for (int j = 0; j < MAX_VPAGES; j++)
-        {
-            PTE pte = PTE();
-            pte.PRESENT = 0;
-            pte.MODIFIED = 0;
-            pte.REFERENCED = 0;
-            pte.PAGEDOUT = 0;
-            pte.WRITE_PROTECT = 0;
-            pte.FILE_MAPPED = 0;
-            process->pageTable[j] = pte;
-        }
+        process->buildVMAIndex();
 
         // Add the process to the processes vector
         processes.push_back(process);
     }
 }
 
-// A function to read the random values from the random file and populate the randomValues array
-void readRandomFile(FILE *randomFile)
+// A BinaryTrace class to store a binary instruction trace mapped into memory
+// The trace starts with the magic number and a header of varints holding the number of processes and, for each
+// process, the number of VMAs and the start page, end page, write protection and file mapping of each VMA.
+// The instructions follow as an operation byte and the operand as an unsigned LEB128 varint
+class BinaryTrace
+{
+public:
+    const uint8_t *data; // The mapped trace
+    size_t size;         // The size of the trace
+    size_t position;     // The position of the next byte to read
+};
+
+const uint32_t BINARY_TRACE_MAGIC = 0x54554d4d; // The magic number identifying a binary trace, "MMUT"
+
+// The binary trace being simulated, or nullptr if the input file is a text trace
+BinaryTrace *binaryTrace = nullptr;
+
+// A function to write a value to a binary trace as an unsigned LEB128 varint
+void writeVarint(FILE *file, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        fputc((value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+    fputc(value, file);
+}
+
+// A function to read an unsigned LEB128 varint from the binary trace
+uint32_t readVarint(BinaryTrace *trace)
 {
-    static char line[1024];                    // A buffer to store the line read from the file
-    if (fgets(line, 1024, randomFile) != NULL) // Read the first line to get the number of random values
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35 && trace->position < trace->size; shift += 7)
     {
-        MAX_RANDOM_VALUES_LENGTH = atoi(line);                               // Set the number of random values
-        randomValues = (int *)calloc(MAX_RANDOM_VALUES_LENGTH, sizeof(int)); // Allocate memory for the random values
-        for (int i = 0; i < MAX_RANDOM_VALUES_LENGTH; i++)
+        uint8_t byte = trace->data[trace->position++];
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if (byte < 0x80)
+            return value;
+    }
+    cout << "Error: Binary trace is truncated." << endl;
+    exit(1);
+}
+
+// A function to test if the input file is a binary trace by its magic number
+bool isBinaryTrace(FILE *inputFile)
+{
+    uint32_t magic = 0;
+    bool binary = fread(&magic, sizeof(uint32_t), 1, inputFile) == 1 && magic == BINARY_TRACE_MAGIC;
+    rewind(inputFile);
+    return binary;
+}
+
+// A function to map a binary trace and populate the processes from its header
+// The mapping is read-only and the instructions are decoded in place during the simulation
+void readBinaryTrace(FILE *inputFile)
+{
+    struct stat traceStat;
+    if (fstat(fileno(inputFile), &traceStat) != 0)
+    {
+        cout << "Error: Cannot map input file." << endl;
+        exit(1);
+    }
+    void *data = mmap(NULL, traceStat.st_size, PROT_READ, MAP_PRIVATE, fileno(inputFile), 0);
+    if (data == MAP_FAILED)
+    {
+        cout << "Error: Cannot map input file." << endl;
+        exit(1);
+    }
+    madvise(data, traceStat.st_size, MADV_SEQUENTIAL);
+    binaryTrace = new BinaryTrace();
+    binaryTrace->data = (const uint8_t *)data;
+    binaryTrace->size = traceStat.st_size;
+    binaryTrace->position = sizeof(uint32_t);
+
+    // Read the processes and their VMAs
+    int numProcesses = readVarint(binaryTrace);
+    for (int i = 0; i < numProcesses; i++)
+    {
+        Process *process = createProcess(i);
+        int numVMA = readVarint(binaryTrace);
+        for (int j = 0; j < numVMA; j++)
         {
-            // Read each random value
-            if (fgets(line, 1024, randomFile) != NULL)
-                randomValues[i] = atoi(line);
+            VMA vma = VMA();
+            vma.startPage = readVarint(binaryTrace);
+            vma.endPage = readVarint(binaryTrace);
+            vma.writeProtected = readVarint(binaryTrace);
+            vma.fileMapped = readVarint(binaryTrace);
+            process->vmas.push_back(vma);
         }
+        process->buildVMAIndex();
+        processes.push_back(process);
     }
 }
 
-// A function to get the next instruction from the input file
+// A function to get the next instruction from the binary trace
+// Most operands fit in one byte, so the single byte case is decoded without calling readVarint
+bool getNextBinaryInstruction(Instruction *instruction)
+{
+    if (binaryTrace->position >= binaryTrace->size)
+        return false;
+    instruction->operation = binaryTrace->data[binaryTrace->position++];
+    if (binaryTrace->position < binaryTrace->size && binaryTrace->data[binaryTrace->position] < 0x80)
+        instruction->num = binaryTrace->data[binaryTrace->position++];
+    else
+        instruction->num = readVarint(binaryTrace);
+    return true;
+}
+
+// The instructions of the trace loaded into memory once, shared by the simulations running on several threads,
+// or nullptr if the instructions are read from the input file while simulating
+const vector<Instruction> *loadedInstructions = nullptr;
+thread_local size_t nextLoadedInstruction = 0; // The position of the next instruction in the loaded instructions
+
+// A function to get the next instruction from the loaded instructions, or else from the input file, which is
+// either a text or a binary trace
 bool getNextInstruction(FILE *inputFile, Instruction *instruction)
 {
     static char line[1024]; // A buffer to store the line read from the file
 
+    if (loadedInstructions != nullptr)
+    {
+        if (nextLoadedInstruction == loadedInstructions->size())
+            return false;
+        *instruction = (*loadedInstructions)[nextLoadedInstruction++];
+        return true;
+    }
+    if (binaryTrace != nullptr)
+        return getNextBinaryInstruction(instruction);
+
     // Skip lines that begin with a '#'
     while (fgets(line, 1024, inputFile) != NULL && line[0] == '#')
         ;
@@ -562,27 +1006,60 @@ bool getNextInstruction(FILE *inputFile, Instruction *instruction)
     {
         // Read the instruction information
         instruction->operation = line[0];               // Read the operation
-        instruction->num = atoi(strtok(line + 2, " ")); // Read the number
+        instruction->num = strtoul(strtok(line + 2, " "), NULL, 10); // Read the number
         return true;                                    // Return true
     }
 }
 
+// A function to convert a text trace to a binary trace
+void convertToBinaryTrace(FILE *inputFile, FILE *outputFile)
+{
+    readInput(inputFile);
+
+    // Write the header with the processes and their VMAs
+    fwrite(&BINARY_TRACE_MAGIC, sizeof(uint32_t), 1, outputFile);
+    writeVarint(outputFile, processes.size());
+    for (Process *process : processes)
+    {
+        writeVarint(outputFile, process->vmas.size());
+        for (VMA &vma : process->vmas)
+        {
+            writeVarint(outputFile, vma.startPage);
+            writeVarint(outputFile, vma.endPage);
+            writeVarint(outputFile, vma.writeProtected);
+            writeVarint(outputFile, vma.fileMapped);
+        }
+    }
+
+    // Write the instructions
+    Instruction instruction;
+    while (getNextInstruction(inputFile, &instruction))
+    {
+        fputc(instruction.operation, outputFile);
+        writeVarint(outputFile, instruction.num);
+    }
+}
+
 // A function to display the statistics of a single process
-void displayProcessStatistics(Process *process)
+void displayProcessStatistics(Process *process, ostream &out)
 {
-    cout << "PROC[" << process->processNumber << "]: U=" << process->unmaps
-         << " M=" << process->maps << " I=" << process->ins
-         << " O=" << process->outs << " FI=" << process->fins
-         << " FO=" << process->fouts << " Z=" << process->zeros
-         << " SV=" << process->segv << " SP=" << process->segprot << endl;
+    out << "PROC[" << process->processNumber << "]: U=" << process->unmaps
+        << " M=" << process->maps << " I=" << process->ins
+        << " O=" << process->outs << " FI=" << process->fins
+        << " FO=" << process->fouts << " Z=" << process->zeros
+        << " SV=" << process->segv << " SP=" << process->segprot << endl;
 }
 
 // A function to display the statistics of all processes
-void displayAllProcessStatistics(unsigned long instructionCount, unsigned long ctxSwitches, unsigned long processExits, unsigned long long cost)
+void displayAllProcessStatistics(unsigned long instructionCount, unsigned long ctxSwitches, unsigned long processExits, unsigned long long cost, ostream &out)
 {
     for (Process *process : processes)
-        displayProcessStatistics(process);
-    cout << "TOTALCOST " << instructionCount << " " << ctxSwitches << " " << processExits << " " << cost << " " << sizeof(PTE) << endl;
+        displayProcessStatistics(process, out);
+    out << "TOTALCOST " << instructionCount << " " << ctxSwitches << " " << processExits << " " << cost << " " << sizeof(PTE) << endl;
+    if (tlb != nullptr)
+        out << "TLB: lookups=" << tlb->lookups << " hits=" << tlb->hits << " misses=" << tlb->lookups - tlb->hits
+            << " hitrate=" << fixed << setprecision(2) << (tlb->lookups > 0 ? 100.0 * tlb->hits / tlb->lookups : 0.0)
+            << "% flushes=" << tlb->flushes << " invalidations=" << tlb->invalidations << " cost=" << tlb->cost << endl;
 }
 
 // A function to display the frame table
@@ -600,12 +1077,14 @@ void displayFrameTable()
 }
 
 // A function to display the page table of a process
+// Every page of the address space is printed, so its cost grows with the address space and not with the mapped pages
 void displayProcessPageTable(Process *process)
 {
     cout << "PT[" << process->processNumber << "]:";
-    for (int i = 0; i < MAX_VPAGES; i++)
+    for (uint64_t i = 0; i < numVirtualPages; i++)
     {
-        PTE pte = process->pageTable[i];
+        PTE *entry = process->pageTable.find(i);
+        PTE pte = entry != nullptr ? *entry : PTE();
         if (pte.PRESENT)
             cout << " " << i << ":"
                  << (pte.REFERENCED ? "R" : "-")
@@ -633,7 +1112,8 @@ void simulate(FILE *inputFile,
               bool displayCurrentPageTableAfterInstructionFlag,
               bool displayAllPageTablesAfterInstructionFlag,
               bool displayFrameTableAfterInstructionFlag,
-              bool displayAgingFlag)
+              bool displayAgingFlag,
+              ostream &statisticsOutput = cout)
 {
     // Initialize the the current instruction, process and page table entry
     Instruction *instruction = new Instruction();
@@ -641,7 +1121,8 @@ void simulate(FILE *inputFile,
     PTE *currentPTE = nullptr;
 
     // Initialize the cost, instruction count, context switches and process exits
-    int vpage;
+    uint32_t vpage;
+    bool tlbMiss, wasReferenced, wasModified;
     unsigned long long cost = 0;
     unsigned long instructionCount = 0, ctxSwitches = 0, processExits = 0;
     while (getNextInstruction(inputFile, instruction)) // Get the next instruction
@@ -659,6 +1140,8 @@ void simulate(FILE *inputFile,
             currentProcess = processes[instruction->num]; // Set the current process to the new process
             ctxSwitches++;                                // Increment the context switches
             cost += 130;                                  // Add the cost for context switches
+            if (tlb != nullptr && !tlbTagged)             // Flush the TLB if its entries are not tagged
+                tlb->flush();
             break;
         case 'e': // Process exit
             // Display the process exit
@@ -666,10 +1149,16 @@ void simulate(FILE *inputFile,
                 cout << "EXIT current process " << currentProcess->processNumber << endl;
 
             // Reset the page table entries for the current process
-            for (int i = 0; i < MAX_VPAGES; i++)
+            for (uint64_t i = 0; i < numVirtualPages; i++)
             {
-                currentPTE = &currentProcess->pageTable[i]; // Fetch the page table entry
-                if (currentPTE->PRESENT)                    // Check if the page is present
+                currentPTE = currentProcess->pageTable.find(i); // Fetch the page table entry
+                if (currentPTE == nullptr)
+                {
+                    // Skip the rest of a leaf table or middle directory that was never allocated
+                    i = currentProcess->pageTable.getUnallocatedRangeEnd(i);
+                    continue;
+                }
+                if (currentPTE->PRESENT) // Check if the page is present
                 {
                     cost += 410; // Add the cost for unmaps
                     // Unmap the page and display the outcome
@@ -700,16 +1189,36 @@ void simulate(FILE *inputFile,
                 currentPTE->WRITE_PROTECT = 0;
                 currentPTE->FILE_MAPPED = 0;
             }
+            if (tlb != nullptr) // Invalidate the TLB entries of the process
+                tlb->invalidateProcess(currentProcess->processNumber);
             processExits++; // Increment the process exits count
             cost += 1230;   // Add the cost for process exits
             break;
         default:       // Handle read and write operations
             cost += 1; // Add the cost for r/w operations
             vpage = instruction->num;
-            // Fetch the page table entry for the virtual page
-            currentPTE = &currentProcess->pageTable[vpage];
-            // Check if the page is not present
-            if (!currentPTE->PRESENT) // Page fault
+            // A page beyond the virtual address space is in no VMA
+            if (vpage >= numVirtualPages)
+            {
+                currentProcess->segv++;            // Increment the segv count
+                cost += 440;                       // Add the cost for segv
+                if (displayInstructionOutcomeFlag) // Display the outcome
+                    cout << " SEGV" << endl;
+                break;
+            }
+            // Look up the page in the TLB, and fetch the page table entry from the page table on a miss
+            currentPTE = nullptr;
+            if (tlb != nullptr)
+            {
+                currentPTE = tlb->lookup(currentProcess->processNumber, vpage);
+                if (currentPTE == nullptr)
+                    cost += TLB_MISS_COST; // Add the cost for walking the page table
+            }
+            tlbMiss = currentPTE == nullptr;
+            if (tlbMiss)
+                currentPTE = currentProcess->pageTable.find(vpage);
+            // Check if the page is not present, including a page whose leaf table was never allocated
+            if (currentPTE == nullptr || !currentPTE->PRESENT) // Page fault
             {
                 // Check if the page is in the virtual memory area of the process
                 VMA *vma = currentProcess->getVMAForPage(vpage); // Fetch the VMA for the page
@@ -723,6 +1232,8 @@ void simulate(FILE *inputFile,
                     break;
                 }
 
+                // Allocate the page table entry only now that the page is known to be in a VMA
+                currentPTE = &currentProcess->pageTable[vpage];
                 // Set the file-mapped and write-protected bits for the page table entry.
                 currentPTE->FILE_MAPPED = vma->fileMapped;
                 currentPTE->WRITE_PROTECT = vma->writeProtected;
@@ -735,6 +1246,8 @@ void simulate(FILE *inputFile,
                     // Identify the process and page table entry for the frame
                     Process *victimProcess = processes[newFrame->processNumber];
                     PTE *victimPTE = &victimProcess->pageTable[newFrame->pageNumber];
+                    if (tlb != nullptr) // Invalidate the TLB entry of the victim page
+                        tlb->invalidate(newFrame->processNumber, newFrame->pageNumber);
                     victimProcess->unmaps++; // Increment the unmaps count
                     cost += 410;             // Add the cost for unmaps
 
@@ -812,7 +1325,13 @@ void simulate(FILE *inputFile,
                     cout << " MAP " << newFrame->frameNumber << endl;
             }
 
+            // Cache the translation after a TLB miss
+            if (tlb != nullptr && tlbMiss)
+                tlb->insert(currentProcess->processNumber, vpage, currentPTE);
+
             // Update the reference bit
+            wasReferenced = currentPTE->REFERENCED;
+            wasModified = currentPTE->MODIFIED;
             currentPTE->REFERENCED = 1;
             // Check if the operation is write
             if (instruction->operation == 'w')
@@ -827,6 +1346,9 @@ void simulate(FILE *inputFile,
                 else
                     currentPTE->MODIFIED = 1; // Set the modified bit
             }
+            // Let the pager follow the change of the bits
+            if (!wasReferenced || wasModified != currentPTE->MODIFIED)
+                pager->pageBitsChanged(&frameTable[currentPTE->FRAME], currentPTE);
             break;
         }
         // Increment the instruction count
@@ -855,7 +1377,7 @@ void simulate(FILE *inputFile,
 
     // Display the Process Statistics
     if (displayProcessStatisticsAfterSimulaitonFlag)
-        displayAllProcessStatistics(instructionCount, ctxSwitches, processExits, cost);
+        displayAllProcessStatistics(instructionCount, ctxSwitches, processExits, cost, statisticsOutput);
 }
 
 // A function to initialize the pager based on the algorithm
@@ -884,12 +1406,107 @@ void initPager(char algo)
     }
 }
 
+// A function to initialize the TLB, if one is simulated
+void initTLB()
+{
+    tlb = tlbEntries > 0 ? new TLB() : nullptr;
+}
+
+// A function to initialize the frame table and the free frames
+void initFrameTable(int numFrames)
+{
+    MAX_FRAMES = numFrames;
+    frameTable = vector<Frame>(MAX_FRAMES);
+    freeFrames.clear();
+    for (int i = 0; i < MAX_FRAMES; i++)
+    {
+        Frame frame = Frame();
+        frame.frameNumber = i;
+        frame.processNumber = -1;
+        frame.pageNumber = -1;
+        frame.timeOfLastUse = -1;
+        frameTable[i] = frame;
+        freeFrames.push_back(&frameTable[i]);
+    }
+}
+
+// A Configuration class to store the algorithm and the number of frames of one simulation of a trace
+class Configuration
+{
+public:
+    char algo;         // The algorithm
+    int numFrames;     // The number of frames
+    string statistics; // The statistics printed at the end of the simulation
+};
+
+// A function to simulate a configuration on the current thread, with its own copy of the processes
+// A thread may simulate several configurations in turn, so the state of the previous one is replaced
+void simulateConfiguration(Configuration *configuration, const vector<Process *> *sourceProcesses, bool displayStatistics)
+{
+    processes.clear();
+    nextLoadedInstruction = 0;
+    for (Process *sourceProcess : *sourceProcesses)
+    {
+        Process *process = createProcess(sourceProcess->processNumber);
+        process->vmas = sourceProcess->vmas;
+        process->vmaIndex = sourceProcess->vmaIndex;
+        process->overlappingVMAs = sourceProcess->overlappingVMAs;
+        processes.push_back(process);
+    }
+    initFrameTable(configuration->numFrames);
+    initPager(configuration->algo);
+    initTLB();
+
+    ostringstream statistics;
+    simulate(NULL, false, false, false, displayStatistics, false, false, false, false, statistics);
+    configuration->statistics = statistics.str();
+
+    for (Process *process : processes)
+        delete process;
+    delete pager;
+    delete tlb;
+}
+
+// A function to simulate several configurations of the same trace, which is parsed only once
+// The configurations are shared out to one thread per core, and their statistics are printed in order
+// Only the statistics (-oS) can be shown, as the per-instruction and table output would interleave
+void simulateAllConfigurations(FILE *inputFile, vector<Configuration> &configurations, bool displayStatistics)
+{
+    // Load the instructions into memory
+    vector<Instruction> instructions;
+    Instruction instruction;
+    while (getNextInstruction(inputFile, &instruction))
+        instructions.push_back(instruction);
+    loadedInstructions = &instructions;
+
+    // Run the configurations on the threads
+    const vector<Process *> *sourceProcesses = &processes;
+    atomic<int> nextConfiguration(0);
+    int numThreads = min((int)configurations.size(), max(1, (int)thread::hardware_concurrency()));
+    vector<thread> threads;
+    for (int i = 0; i < numThreads; i++)
+        threads.push_back(thread([&]()
+                                 {
+                                     for (int j = nextConfiguration++; j < configurations.size(); j = nextConfiguration++)
+                                         simulateConfiguration(&configurations[j], sourceProcesses, displayStatistics);
+                                 }));
+    for (thread &worker : threads)
+        worker.join();
+
+    for (Configuration &configuration : configurations)
+        cout << "CONFIG: a=" << configuration.algo << " f=" << configuration.numFrames << endl
+             << configuration.statistics;
+}
+
 // Main function
 int main(int argc, char *argv[])
 {
     int opt;
-    char algo;                                               // The algorithm
-    const char *optstring = "f:a:o:";                        // The options
+    string algos;                                            // The algorithms
+    vector<int> frameCounts;                                 // The numbers of frames
+    const char *optstring = "f:a:o:b:p:t:R";                 // The options
+    const char *binaryTraceFileName = NULL;                  // The binary trace the input file is converted to
+    bool useRandomCache = false;                             // Whether the binary sidecar of the random file is used
     bool displayInstructionOutcomeFlag = false,              // O
         displayPageTableAfterSimulationFlag = false,         // P
         displayFrameTableAfterSimulationFlag = false,        // F
@@ -904,26 +1521,58 @@ int main(int argc, char *argv[])
     {
         switch (opt)
         {
-        case 'f': // The number of frames
-            MAX_FRAMES = atoi(optarg);
-            // Initialize the frame table and the free frames
-            frameTable = vector<Frame>(MAX_FRAMES);
-            for (int i = 0; i < MAX_FRAMES; i++)
+        case 'f': // The number of frames, or a comma-separated list of frame counts
+            frameCounts.clear();
+            for (char *count = strtok(optarg, ","); count != NULL; count = strtok(NULL, ","))
+            {
+                frameCounts.push_back(atoi(count));
+                if (frameCounts.back() < 1 || frameCounts.back() > MAX_FRAME_COUNT)
+                {
+                    cout << "Error: Number of frames must be between 1 and " << MAX_FRAME_COUNT << "." << endl;
+                    exit(1);
+                }
+            }
+            break;
+        case 'p': // The size of the virtual address space in pages
+            numVirtualPages = strtoull(optarg, NULL, 10);
+            if (numVirtualPages < 1 || numVirtualPages > MAX_VIRTUAL_PAGES)
+            {
+                cout << "Error: Number of virtual pages must be between 1 and " << MAX_VIRTUAL_PAGES << "." << endl;
+                exit(1);
+            }
+            break;
+        case 't': // The TLB as <entries>[:<ways>[:<policy>[:<tagging>]]]
+        {
+            char *entries = strtok(optarg, ":"), *ways = strtok(NULL, ":");
+            char *policy = strtok(NULL, ":"), *tagging = strtok(NULL, ":");
+            tlbEntries = atoi(entries);
+            tlbWays = ways != NULL ? atoi(ways) : tlbEntries;
+            if (tlbEntries < 1 || tlbWays < 1 || tlbEntries % tlbWays != 0)
             {
-                Frame frame = Frame();
-                frame.frameNumber = i;
-                frame.processNumber = -1;
-                frame.pageNumber = -1;
-                frame.timeOfLastUse = -1;
-                frame.age = 0x0;
-                frameTable[i] = frame;
-                freeFrames.push_back(&frameTable[i]);
+                cout << "Error: TLB entries must be a positive multiple of the TLB ways." << endl;
+                exit(1);
+            }
+            tlbPolicy = policy != NULL ? policy[0] : 'l';
+            if (tlbPolicy != 'l' && tlbPolicy != 'f' && tlbPolicy != 'r')
+            {
+                cout << "Error: TLB replacement policy must be l (LRU), f (FIFO) or r (random)." << endl;
+                exit(1);
+            }
+            tlbTagged = tagging != NULL && tagging[0] == 'a';
+            if (tagging != NULL && tagging[0] != 'a' && tagging[0] != 'f')
+            {
+                cout << "Error: TLB tagging must be a (ASID) or f (flush on context switch)." << endl;
+                exit(1);
             }
             break;
-        case 'a': // The algorithm
-            algo = *optarg;
-            // Initialize the pager based on the algorithm
-            initPager(algo);
+        }
+        case 'a': // The algorithm, or several algorithms as a string of their letters
+            algos = optarg;
+            if (algos.empty() || algos.find_first_not_of("frceaw") != string::npos)
+            {
+                cout << "Error: Algorithms must be letters of f, r, c, e, a and w." << endl;
+                exit(1);
+            }
             break;
         case 'o': // The options
             for (int i = 0; i < strlen(optarg); i++)
@@ -957,11 +1606,28 @@ int main(int argc, char *argv[])
                 }
             }
             break;
+        case 'R': // Use the binary sidecar of the random file
+            useRandomCache = true;
+            break;
+        case 'b': // Convert the input file to a binary trace and exit
+            binaryTraceFileName = optarg;
+            break;
         }
     }
 
+    // Several configurations are simulated at once, so only their statistics can be shown
+    if (algos.size() * frameCounts.size() > 1 &&
+        (displayInstructionOutcomeFlag || displayPageTableAfterSimulationFlag || displayFrameTableAfterSimulationFlag ||
+         displayCurrentPageTableAfterInstructionFlag || displayAllPageTablesAfterInstructionFlag ||
+         displayFrameTableAfterInstructionFlag || displayAgingFlag))
+    {
+        cout << "Error: Only the S option can be used with several algorithms or frame counts." << endl;
+        exit(1);
+    }
+
     // File pointers for the input and random files
     FILE *inputFile, *randomFile;
+    const char *randomFileName;
     // Check if the input file has been specified
     if (optind < argc)
     {
@@ -972,11 +1638,30 @@ int main(int argc, char *argv[])
             cout << "Error: Cannot open input file." << endl;
             exit(1);
         }
+        // Convert the input file to a binary trace if requested, which needs no random file
+        if (binaryTraceFileName != NULL)
+        {
+            FILE *binaryTraceFile = fopen(binaryTraceFileName, "wb");
+            if (binaryTraceFile == NULL)
+            {
+                cout << "Error: Cannot open binary trace file." << endl;
+                exit(1);
+            }
+            if (isBinaryTrace(inputFile))
+            {
+                cout << "Error: Input file is already a binary trace." << endl;
+                exit(1);
+            }
+            convertToBinaryTrace(inputFile, binaryTraceFile);
+            fclose(binaryTraceFile);
+            exit(0);
+        }
         // Check if the random file has been specified
         if (optind < argc)
         {
             // Open the random file
-            randomFile = fopen(argv[optind++], "r");
+            randomFileName = argv[optind++];
+            randomFile = fopen(randomFileName, "r");
             if (randomFile == NULL) // Check if the random file can be opened
             {
                 cout << "Error: Cannot open random file." << endl;
@@ -995,11 +1680,34 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
-    // Read the input file and populate the processes
-    readInput(inputFile);
+    // Read the input file and populate the processes, mapping it if it is a binary trace
+    if (isBinaryTrace(inputFile))
+        readBinaryTrace(inputFile);
+    else
+        readInput(inputFile);
 
     // Read the random values from the random file
-    readRandomFile(randomFile);
+    readRandomFile(randomFile, randomFileName, useRandomCache);
+
+    // Simulate every combination of algorithm and frame count in one pass over the trace if there are several
+    if (algos.size() * frameCounts.size() > 1)
+    {
+        vector<Configuration> configurations;
+        for (char algo : algos)
+            for (int numFrames : frameCounts)
+                configurations.push_back(Configuration{algo, numFrames, ""});
+        simulateAllConfigurations(inputFile, configurations, displayProcessStatisticsAfterSimulaitonFlag);
+        fclose(inputFile);
+        fclose(randomFile);
+        return 0;
+    }
+
+    // Initialize the frame table and the pager
+    if (!frameCounts.empty())
+        initFrameTable(frameCounts[0]);
+    if (!algos.empty())
+        initPager(algos[0]);
+    initTLB();
 
     // Run the event simulation
     simulate(inputFile, displayInstructionOutcomeFlag, displayPageTableAfterSimulationFlag, displayFrameTableAfterSimulationFlag, displayProcessStatisticsAfterSimulaitonFlag, displayCurrentPageTableAfterInstructionFlag, displayAllPageTablesAfterInstructionFlag, displayFrameTableAfterInstructionFlag, displayAgingFlag);